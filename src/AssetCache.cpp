@@ -0,0 +1,95 @@
+/*
+ * [PaperPup]
+ *   AssetCache.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "AssetCache.h"
+
+#include "Platform/Common/Hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace PaperPup
+{
+	// Asset cache interface
+	AssetCache &AssetCache::Get()
+	{
+		// Shared by every mounted image
+		static AssetCache cache;
+		return cache;
+	}
+
+	uint64_t AssetCache::HashContents(const Filesystem::File *file)
+	{
+		return Hash::FNV1a(file->Data(), file->Size());
+	}
+
+	std::shared_ptr<AssetData> AssetCache::Find(AssetType type, uint64_t hash, const Filesystem::File *file)
+	{
+		std::shared_ptr<AssetData> live;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto entry = entries.find({ hash, file->Size(), type });
+			if (entry == entries.end())
+				return nullptr;
+			live = entry->second.lock();
+		}
+
+		// Compare outside the lock, cached contents never change
+		if (live == nullptr || !Same(*live, file))
+			return nullptr;
+		return live;
+	}
+
+	std::shared_ptr<AssetData> AssetCache::Insert(AssetType type, uint64_t hash, std::shared_ptr<AssetData> data)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// Use live asset if one with the same contents was inserted while we were decoding
+		std::weak_ptr<AssetData> &entry = entries[{ hash, data->file->Size(), type }];
+		if (std::shared_ptr<AssetData> live = entry.lock())
+		{
+			// A colliding asset keeps its own copy, uncached
+			if (Same(*live, data->file.get()))
+				return live;
+			return data;
+		}
+		entry = data;
+
+		// Drop freed assets once the cache doubles
+		if (entries.size() >= entries_prune)
+			Prune();
+		return data;
+	}
+
+	size_t AssetCache::Live()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Prune();
+		return entries.size();
+	}
+
+	bool AssetCache::Same(const AssetData &data, const Filesystem::File *file)
+	{
+		return data.file->Size() == file->Size() && std::memcmp(data.file->Data(), file->Data(), file->Size()) == 0;
+	}
+
+	void AssetCache::Prune()
+	{
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			if (it->second.expired())
+				it = entries.erase(it);
+			else
+				++it;
+		}
+		entries_prune = std::max<size_t>(entries.size() * 2, 0x40);
+	}
+}
@@ -0,0 +1,92 @@
+/*
+ * [PaperPup]
+ *   AssetCache.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "PaperPup.h"
+
+#include "Platform/Filesystem.h"
+#include "Platform/Render.h"
+#include "Platform/Common/TIM.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace PaperPup
+{
+	// Asset types
+	enum class AssetType
+	{
+		Data,
+		Texture,
+		Sound,
+		Track // CD-DA track, streamed from the image rather than read and cached
+	};
+
+	// Asset data, shared by every asset with the same contents
+	struct AssetData
+	{
+		// File contents, used by data and sounds (SPU blocks), and kept for every type to check cache hits against
+		// Textures keep their decoded form as written by TIM::Serialize, whether they were read raw or pre-decoded
+		std::unique_ptr<Filesystem::File> file;
+
+		// Decoded texture, freed once uploaded on its own, textures packed into atlases keep it for every loader to pack
+		TIM::Image image;
+		std::unique_ptr<Render::Texture> texture;
+	};
+
+	// Asset cache class
+	// Packs often carry copies of the same base game files, so decoded assets are keyed by content
+	// Hits are compared byte for byte, the hash only finds the candidate
+	// The cache only holds weak references, assets are freed once no loader uses them
+	class AssetCache
+	{
+		private:
+			// Cache key, files that collide on all three aren't shared, the first one keeps the entry
+			struct Key
+			{
+				uint64_t hash;
+				size_t size;
+				AssetType type;
+
+				bool operator==(const Key &other) const { return hash == other.hash && size == other.size && type == other.type; }
+			};
+
+			struct KeyHash
+			{
+				size_t operator()(const Key &key) const { return (size_t)key.hash; }
+			};
+
+			// Cached assets
+			std::mutex mutex;
+			std::unordered_map<Key, std::weak_ptr<AssetData>, KeyHash> entries;
+			size_t entries_prune = 0x40;
+
+		public:
+			// Asset cache interface
+			static AssetCache &Get();
+
+			static uint64_t HashContents(const Filesystem::File *file);
+
+			// Finds a live asset with the same contents
+			std::shared_ptr<AssetData> Find(AssetType type, uint64_t hash, const Filesystem::File *file);
+
+			// Adds an asset, returning the existing one instead if another thread got there first
+			std::shared_ptr<AssetData> Insert(AssetType type, uint64_t hash, std::shared_ptr<AssetData> data);
+
+			size_t Live();
+
+		private:
+			static bool Same(const AssetData &data, const Filesystem::File *file);
+			void Prune();
+	};
+}
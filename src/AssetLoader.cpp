@@ -0,0 +1,392 @@
+/*
+ * [PaperPup]
+ *   AssetLoader.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "AssetLoader.h"
+
+#include "Engine.h"
+
+#include "Platform/Userdata.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+
+namespace PaperPup
+{
+	// Asset loader constants
+	static constexpr size_t ASSET_PAGE_SIZE = 0x1000;
+
+	// Asset loader interface
+	AssetLoader::AssetLoader(std::string _image_name, std::vector<AssetRequest> requests) : image_name(std::move(_image_name))
+	{
+		// Create assets
+		assets.resize(requests.size());
+		for (size_t i = 0; i < requests.size(); i++)
+			assets[i].request = std::move(requests[i]);
+
+		// Name our atlas after our image and textures, so each song keeps its own layout cached
+		uint64_t atlas_hash = Hash::FNV1a(image_name);
+		for (auto &asset : assets)
+		{
+			if (asset.request.type != AssetType::Texture)
+				continue;
+			atlas_hash = Hash::FNV1a(asset.request.path, atlas_hash);
+			textures_total++;
+		}
+		char atlas_hex[17];
+		std::snprintf(atlas_hex, sizeof(atlas_hex), "%016llX", (unsigned long long)atlas_hash);
+		atlas_name = atlas_hex;
+
+		upload_budget_us = (double)Userdata::GetInteger("loader/upload_budget_us", 2000);
+		if (assets.empty())
+			return;
+
+		// Start decode threads, loader/decode_threads of 0 leaves a hardware thread for the I/O and main threads
+		int threads = Userdata::GetInteger("loader/decode_threads", 0);
+		if (threads <= 0)
+			threads = (int)std::max(std::thread::hardware_concurrency(), 2U) - 1;
+		threads = std::min(threads, (int)assets.size());
+
+		for (int i = 0; i < threads; i++)
+			decode_threads.emplace_back(&AssetLoader::Decode, this);
+
+		// Start I/O thread
+		io_thread = std::thread(&AssetLoader::IO, this);
+	}
+
+	AssetLoader::~AssetLoader()
+	{
+		// Stop stage threads after their current asset
+		threads_run = false;
+		if (io_thread.joinable())
+			io_thread.join();
+
+		{
+			std::lock_guard<std::mutex> lock(decode_mutex);
+			decode_end = true;
+		}
+		decode_cv.notify_all();
+		for (auto &thread : decode_threads)
+			thread.join();
+	}
+
+	bool AssetLoader::Upload()
+	{
+		// Upload decoded assets until our budget runs out
+		auto upload_start = std::chrono::steady_clock::now();
+		while (1)
+		{
+			size_t index;
+			{
+				std::lock_guard<std::mutex> lock(upload_mutex);
+				if (upload_queue.empty())
+					break;
+				index = upload_queue.front();
+				upload_queue.pop_front();
+			}
+
+			Asset &asset = assets[index];
+			if (asset.request.type == AssetType::Texture)
+			{
+				// Textures that fit wait for the atlas, it's laid out from all of them at once
+				textures_ready++;
+				if (asset.error.empty() && asset.data->texture == nullptr && atlas.Fits(asset.data->image.width, asset.data->image.height))
+				{
+					atlas_pending.push_back(index);
+					continue;
+				}
+			}
+
+			if (asset.error.empty())
+			{
+				try
+				{
+					switch (asset.request.type)
+					{
+						case AssetType::Data:
+							break;
+						case AssetType::Texture:
+							// Create texture unless a shared copy already has, the decoded pixels aren't needed after
+							if (asset.data->texture == nullptr)
+							{
+								asset.data->texture.reset(Render::Texture::New(Render::TextureBind::Resource, asset.data->image.width, asset.data->image.height, asset.data->image.data.data()));
+								asset.data->image = TIM::Image();
+							}
+							break;
+						case AssetType::Sound:
+							// Create sound playing from the shared blocks
+							asset.sound.reset(Audio::Sound<ADPCM::SPU::Channel>::New((ADPCM::SPU::Block*)asset.data->file->Data(), asset.data->file->Size() / sizeof(ADPCM::SPU::Block), 0, 0));
+							break;
+						case AssetType::Track:
+							break;
+					}
+				}
+				catch (std::exception &exception)
+				{
+					asset.error = exception.what();
+				}
+			}
+			asset.done = true;
+			uploaded++;
+
+			if (std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - upload_start).count() >= upload_budget_us)
+				break;
+		}
+
+		// Pack the atlas once every texture is in
+		if (!atlas_pending.empty() && textures_ready == textures_total)
+			BuildAtlas();
+
+		// Report progress
+		g_engine->LoadProgress(uploaded, assets.size());
+		return Done();
+	}
+
+	const Asset *AssetLoader::Find(const std::string &path) const
+	{
+		// Find loaded asset
+		for (auto &asset : assets)
+		{
+			if (asset.done && asset.error.empty() && asset.request.type != AssetType::Track && asset.request.path == path)
+				return &asset;
+		}
+		return nullptr;
+	}
+
+	const Asset *AssetLoader::At(size_t index) const
+	{
+		if (index >= assets.size() || !assets[index].done || !assets[index].error.empty())
+			return nullptr;
+		return &assets[index];
+	}
+
+	Filesystem::File *AssetLoader::File(const std::string &path) const
+	{
+		const Asset *asset = Find(path);
+		if (asset == nullptr)
+			return nullptr;
+		return new Filesystem::File(asset->data->file->Data(), asset->data->file->Size(), std::shared_ptr<const void>(asset->data));
+	}
+
+	Render::Texture *AssetLoader::Texture(const std::string &path) const
+	{
+		const Asset *asset = Find(path);
+		if (asset == nullptr)
+			return nullptr;
+		if (asset->rect != nullptr)
+			return atlas.Page(asset->rect->page);
+		return asset->data->texture.get();
+	}
+
+	const Render::AtlasRect *AssetLoader::Rect(const std::string &path) const
+	{
+		const Asset *asset = Find(path);
+		return (asset != nullptr) ? asset->rect : nullptr;
+	}
+
+	Audio::Sound<ADPCM::SPU::Channel> *AssetLoader::Sound(const std::string &path) const
+	{
+		const Asset *asset = Find(path);
+		return (asset != nullptr) ? asset->sound.get() : nullptr;
+	}
+
+	Audio::Sound<CDDA::Track> *AssetLoader::Track(unsigned int number) const
+	{
+		// Find loaded track
+		for (auto &asset : assets)
+		{
+			if (asset.done && asset.error.empty() && asset.request.type == AssetType::Track && asset.request.track == number)
+				return asset.track.get();
+		}
+		return nullptr;
+	}
+
+	void AssetLoader::BuildAtlas()
+	{
+		// Add waiting textures, their decoded images are only referenced until the atlas is built
+		try
+		{
+			for (size_t index : atlas_pending)
+			{
+				Asset &asset = assets[index];
+				if (atlas.Find(asset.request.path) == nullptr)
+					atlas.Add(asset.request.path, asset.data->image.width, asset.data->image.height, asset.data->image.data.data());
+			}
+			atlas.Build(atlas_name);
+		}
+		catch (std::exception &exception)
+		{
+			for (size_t index : atlas_pending)
+				assets[index].error = exception.what();
+		}
+
+		for (size_t index : atlas_pending)
+		{
+			Asset &asset = assets[index];
+			if (asset.error.empty())
+				asset.rect = atlas.Find(asset.request.path);
+			asset.done = true;
+			uploaded++;
+		}
+		atlas_pending.clear();
+	}
+
+	void AssetLoader::IO()
+	{
+		// Open our own image, images share one file handle so they can't be read from two threads
+		std::unique_ptr<Filesystem::Image> image;
+		try
+		{
+			image.reset(Filesystem::Image::Open(image_name));
+		}
+		catch (std::exception &exception) { (void)exception; }
+
+		for (size_t i = 0; i < assets.size() && threads_run; i++)
+		{
+			// Read file
+			Asset &asset = assets[i];
+			try
+			{
+				if (image == nullptr)
+					throw PaperPup::RuntimeError(image_name + " image could not be opened");
+				if (asset.request.type == AssetType::Track)
+				{
+					// Tracks stream from their own handle, there's nothing to read ahead
+					asset.track.reset(image->OpenTrack(asset.request.track));
+					if (asset.track == nullptr)
+						throw PaperPup::RuntimeError(asset.request.path + " not found");
+				}
+				else
+				{
+					if (asset.request.type == AssetType::Texture)
+					{
+						asset.file.reset(image->OpenTexture(asset.request.path));
+						asset.predecoded = asset.file != nullptr;
+					}
+					if (asset.file == nullptr)
+						asset.file.reset(image->OpenFile(asset.request.path, asset.request.mode2));
+					if (asset.file == nullptr)
+						throw PaperPup::RuntimeError(asset.request.path + " not found");
+
+					// Files borrowed from a mapped bundle are read on first touch, fault them in here rather than while decoding
+					if (asset.file->Hold() != nullptr)
+					{
+						volatile char touch = 0;
+						for (size_t j = 0; j < asset.file->Size(); j += ASSET_PAGE_SIZE)
+							touch = touch + asset.file->Data()[j];
+					}
+				}
+			}
+			catch (std::exception &exception)
+			{
+				asset.error = exception.what();
+			}
+
+			// Pass to decode stage
+			{
+				std::lock_guard<std::mutex> lock(decode_mutex);
+				decode_queue.push_back(i);
+			}
+			decode_cv.notify_one();
+		}
+
+		// Let decode threads finish once the queue is empty
+		{
+			std::lock_guard<std::mutex> lock(decode_mutex);
+			decode_end = true;
+		}
+		decode_cv.notify_all();
+	}
+
+	void AssetLoader::Decode()
+	{
+		while (1)
+		{
+			// Take next read asset
+			size_t index;
+			{
+				std::unique_lock<std::mutex> lock(decode_mutex);
+				decode_cv.wait(lock, [this]() { return !decode_queue.empty() || decode_end; });
+				if (decode_queue.empty() || !threads_run)
+					break;
+				index = decode_queue.front();
+				decode_queue.pop_front();
+			}
+
+			// Decode asset
+			DecodeAsset(assets[index]);
+
+			// Pass to upload stage
+			std::lock_guard<std::mutex> lock(upload_mutex);
+			upload_queue.push_back(index);
+		}
+	}
+
+	void AssetLoader::DecodeAsset(Asset &asset)
+	{
+		// Tracks are decoded as they play
+		if (!asset.error.empty() || asset.request.type == AssetType::Track)
+			return;
+
+		try
+		{
+			// Textures are keyed by their decoded form, so raw TIMs share with the same texture pre-decoded in a bundle
+			TIM::Image image;
+			if (asset.request.type == AssetType::Texture && !asset.predecoded)
+			{
+				image = TIM::Decode((char*)asset.file->Data(), asset.file->Size());
+				std::vector<char> serialized = TIM::Serialize(image);
+				char *serialized_data = new char[serialized.size()];
+				std::memcpy(serialized_data, serialized.data(), serialized.size());
+				asset.file.reset(new Filesystem::File(serialized_data, serialized.size()));
+			}
+
+			// Share an already decoded copy of the same contents
+			uint64_t hash = AssetCache::HashContents(asset.file.get());
+			if ((asset.data = AssetCache::Get().Find(asset.request.type, hash, asset.file.get())) != nullptr)
+			{
+				asset.file.reset();
+				return;
+			}
+
+			std::shared_ptr<AssetData> data = std::make_shared<AssetData>();
+			switch (asset.request.type)
+			{
+				case AssetType::Data:
+					break;
+				case AssetType::Texture:
+					// The serialized form stays only to check cache hits against
+					if (asset.predecoded)
+						data->image = TIM::Deserialize(asset.file->Data(), asset.file->Size());
+					else
+						data->image = std::move(image);
+					break;
+				case AssetType::Sound:
+					// Sound banks are already SPU blocks
+					if ((asset.file->Size() % sizeof(ADPCM::SPU::Block)) != 0)
+						throw PaperPup::RuntimeError(asset.request.path + " is not made of SPU blocks");
+					break;
+				case AssetType::Track:
+					break;
+			}
+			data->file = std::move(asset.file);
+
+			// Cache decoded asset
+			asset.data = AssetCache::Get().Insert(asset.request.type, hash, std::move(data));
+		}
+		catch (std::exception &exception)
+		{
+			asset.error = exception.what();
+			asset.file.reset();
+		}
+	}
+}
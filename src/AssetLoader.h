@@ -0,0 +1,144 @@
+/*
+ * [PaperPup]
+ *   AssetLoader.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "PaperPup.h"
+
+#include "AssetCache.h"
+
+#include "Platform/Filesystem.h"
+#include "Platform/Render.h"
+#include "Platform/Audio.h"
+#include "Platform/Common/ADPCM.h"
+#include "Platform/Common/CDDA.h"
+#include "Platform/Common/TIM.h"
+#include "Platform/Common/Atlas.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace PaperPup
+{
+	// Asset loader class
+	// Assets move through three stages, so reading the image is never waiting on decoding:
+	//   I/O    - one thread reads files from the image in manifest order
+	//   Decode - a pool of threads decodes files as they're read
+	//   Upload - the main thread creates GPU and SPU resources within a per-frame budget
+	// Textures that fit are packed into the loader's atlas once every texture is decoded, rather than getting a texture each
+	// Decoded assets are shared through the asset cache, so identical files in different images are only kept once
+	struct AssetRequest
+	{
+		// Asset path in the image
+		std::string path;
+		AssetType type = AssetType::Data;
+		bool mode2 = false;
+
+		// Audio track number, for tracks
+		unsigned int track = 0;
+	};
+
+	struct Asset
+	{
+		// Asset request
+		AssetRequest request;
+
+		// File read by the I/O stage, textures may come pre-decoded from a bundle
+		std::unique_ptr<Filesystem::File> file;
+		bool predecoded = false;
+
+		// Decoded asset, shared with identical assets
+		std::shared_ptr<AssetData> data;
+
+		// Sound playing from the asset's blocks
+		std::unique_ptr<Audio::Sound<ADPCM::SPU::Channel>> sound;
+
+		// Audio track opened by the I/O stage
+		std::unique_ptr<Audio::Sound<CDDA::Track>> track;
+
+		// Where the texture was packed, if it's in the atlas
+		const Render::AtlasRect *rect = nullptr;
+
+		// Error that stopped the asset loading
+		std::string error;
+
+		// Set once the asset has passed every stage
+		bool done = false;
+	};
+
+	class AssetLoader
+	{
+		private:
+			// Image to read from, only used by the I/O thread
+			std::string image_name;
+
+			// Assets, in manifest order
+			std::vector<Asset> assets;
+
+			// Stage queues
+			std::mutex decode_mutex;
+			std::condition_variable decode_cv;
+			std::deque<size_t> decode_queue;
+			bool decode_end = false;
+
+			std::mutex upload_mutex;
+			std::deque<size_t> upload_queue;
+
+			size_t uploaded = 0;
+			double upload_budget_us;
+
+			// Texture atlas, named for its layout cache
+			Render::Atlas atlas;
+			std::string atlas_name;
+			std::vector<size_t> atlas_pending;
+			size_t textures_total = 0, textures_ready = 0;
+
+			// Stage threads
+			std::thread io_thread;
+			std::vector<std::thread> decode_threads;
+			std::atomic<bool> threads_run{true};
+
+		public:
+			// Asset loader interface
+			AssetLoader(std::string _image_name, std::vector<AssetRequest> requests);
+			~AssetLoader();
+
+			// Uploads decoded assets, call once per frame from the main thread
+			// Reports progress to the current state, returns true once every asset is done
+			bool Upload();
+
+			size_t Loaded() const { return uploaded; }
+			size_t Total() const { return assets.size(); }
+			bool Done() const { return uploaded == assets.size(); }
+
+			// Get loaded assets, nullptr if the asset isn't loaded
+			// Files are new views of the shared contents owned by the caller, so each reader has its own cursor
+			const Asset *Find(const std::string &path) const;
+			const Asset *At(size_t index) const; // By manifest position
+			Filesystem::File *File(const std::string &path) const;
+			Render::Texture *Texture(const std::string &path) const; // The atlas page for packed textures
+			const Render::AtlasRect *Rect(const std::string &path) const; // nullptr for textures that aren't packed
+			Audio::Sound<ADPCM::SPU::Channel> *Sound(const std::string &path) const;
+			Audio::Sound<CDDA::Track> *Track(unsigned int number) const;
+
+		private:
+			void IO();
+			void Decode();
+			void DecodeAsset(Asset &asset);
+			void BuildAtlas();
+	};
+}
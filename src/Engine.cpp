@@ -13,10 +13,14 @@
 
 #include "Menu/Menu.h"
 
+#include "LuaController.h"
+
 #include "Platform/Userdata.h"
 #include "Platform/Render.h"
 #include "Platform/Input.h"
 
+#include <algorithm>
+
 namespace PaperPup
 {
 	// Engine global
@@ -34,11 +38,15 @@ namespace PaperPup
 		Render::SetWindow(Userdata::GetInteger("render/window_width", 1280), Userdata::GetInteger("render/window_height", 720));
 		Render::SetFullscreen(Userdata::GetBool("render/fullscreen", false));
 		Render::SetSync(Userdata::GetBool("render/limiter_enabled", false), Userdata::GetInteger("render/limiter", 60), Userdata::GetBool("render/tearing_enabled", false), Userdata::GetBool("render/vsync_enabled", true));
+
+		// Get Lua garbage collection budget
+		lua_gc_budget_us = Userdata::GetInteger("lua/gc_budget_us", 1000);
 	}
 
 	Engine::~Engine()
 	{
-		
+		// Release the main thread's Lua template while the engine can still write its profile
+		Lua::LuaController::ReleaseTemplate();
 	}
 
 	bool Engine::StartFrame()
@@ -50,15 +58,41 @@ namespace PaperPup
 		if (Input::HandleEvents())
 			return true;
 
+		// Resume Lua threads waiting on this frame
+		for (auto &controller : lua_controllers)
+			controller->StepFrame();
+
 		return false;
 	}
 
 	void Engine::EndFrame()
 	{
+		// Run the frame's script commands
+		for (auto &controller : lua_controllers)
+			controller->DispatchCommands();
+
+		// Collect Lua garbage once the frame's work is done, sharing the budget between controllers
+		if (!lua_controllers.empty())
+		{
+			double budget_us = lua_gc_budget_us / lua_controllers.size();
+			for (auto &controller : lua_controllers)
+				controller->StepGC(budget_us);
+		}
+
 		// End render frame
 		Render::EndFrame();
 	}
 
+	void Engine::AttachLua(Lua::LuaController *controller)
+	{
+		lua_controllers.push_back(controller);
+	}
+
+	void Engine::DetachLua(Lua::LuaController *controller)
+	{
+		lua_controllers.erase(std::remove(lua_controllers.begin(), lua_controllers.end(), controller), lua_controllers.end());
+	}
+
 	void Engine::Start()
 	{
 		// Engine loop
@@ -16,9 +16,16 @@
 #include "Platform/Filesystem.h"
 
 #include <memory>
+#include <vector>
+#include <mutex>
 
 namespace PaperPup
 {
+	namespace Lua
+	{
+		class LuaController;
+	}
+
 	// Engine class
 	class State
 	{
@@ -30,6 +37,10 @@ namespace PaperPup
 
 			virtual Filesystem::Archive *OpenArchive(std::string name) = 0;
 			virtual Filesystem::File *OpenFile(std::string name, bool mode2 = false) = 0;
+			virtual Filesystem::File *OpenBytecode(std::string name) = 0;
+
+			// Called as assets finish loading, so the state can draw a loading screen
+			virtual void LoadProgress(size_t loaded, size_t total) { (void)loaded; (void)total; }
 	};
 
 	class Engine
@@ -38,9 +49,16 @@ namespace PaperPup
 			// Main image
 			std::unique_ptr<Filesystem::Image> image_main;
 
+			// Images read through a single file handle, and packs load their scripts on worker threads
+			std::mutex open_mutex;
+
 			// Engine state
 			std::unique_ptr<State> state;
 
+			// Frame driven Lua controllers and their collection budget
+			std::vector<Lua::LuaController*> lua_controllers;
+			double lua_gc_budget_us;
+
 		public:
 			// Engine interface
 			Engine();
@@ -51,8 +69,18 @@ namespace PaperPup
 			bool StartFrame();
 			void EndFrame();
 
+			void AttachLua(Lua::LuaController *controller);
+			void DetachLua(Lua::LuaController *controller);
+
+			void LoadProgress(size_t loaded, size_t total)
+			{
+				if (state != nullptr)
+					state->LoadProgress(loaded, total);
+			}
+
 			Filesystem::Archive *OpenArchive(std::string name)
 			{
+				std::lock_guard<std::mutex> lock(open_mutex);
 				Filesystem::Archive *archive;
 				if (state != nullptr)
 				{
@@ -69,6 +97,7 @@ namespace PaperPup
 
 			Filesystem::File *OpenFile(std::string name, bool mode2 = false)
 			{
+				std::lock_guard<std::mutex> lock(open_mutex);
 				Filesystem::File *file;
 				if (state != nullptr)
 				{
@@ -82,6 +111,48 @@ namespace PaperPup
 				}
 				return nullptr;
 			}
+
+			Filesystem::Mem *OpenMem(std::string archive_name, std::string name, uint32_t base)
+			{
+				// Open blob from the first archive that has it
+				std::lock_guard<std::mutex> lock(open_mutex);
+				std::unique_ptr<Filesystem::Archive> archive;
+				Filesystem::Mem *mem;
+				if (state != nullptr)
+				{
+					archive.reset(state->OpenArchive(archive_name));
+					if (archive != nullptr && (mem = archive->OpenMem(name, base)) != nullptr)
+						return mem;
+				}
+				if (image_main != nullptr)
+				{
+					archive.reset(image_main->OpenArchive(archive_name));
+					if (archive != nullptr && (mem = archive->OpenMem(name, base)) != nullptr)
+						return mem;
+				}
+				return nullptr;
+			}
+
+			Filesystem::File *OpenBytecode(std::string name)
+			{
+				std::lock_guard<std::mutex> lock(open_mutex);
+				Filesystem::File *file;
+				if (state != nullptr)
+				{
+					if ((file = state->OpenBytecode(name)) != nullptr)
+						return file;
+
+					// Source provided by the state shadows main image bytecode
+					if (std::unique_ptr<Filesystem::File>(state->OpenFile(name, false)) != nullptr)
+						return nullptr;
+				}
+				if (image_main != nullptr)
+				{
+					if ((file = image_main->OpenBytecode(name)) != nullptr)
+						return file;
+				}
+				return nullptr;
+			}
 	};
 
 	// Engine global
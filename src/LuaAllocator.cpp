@@ -0,0 +1,132 @@
+/*
+ * [PaperPup]
+ *   LuaAllocator.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "LuaAllocator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		// Allocator interface
+		Allocator::~Allocator()
+		{
+			// Free slabs
+			for (void *slab : slabs)
+				std::free(slab);
+		}
+
+		void *Allocator::Alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+		{
+			Allocator *allocator = (Allocator*)ud;
+
+			// Luau passes the block's real size as osize, so blocks need no header
+			if (ptr == nullptr)
+				osize = 0;
+
+			// Free block
+			if (nsize == 0)
+			{
+				if (ptr != nullptr)
+				{
+					allocator->Free(ptr, osize);
+					allocator->used -= osize;
+				}
+				return nullptr;
+			}
+
+			// Refuse to grow past the limit, Luau raises a memory error for us
+			if (nsize > osize && allocator->limit != 0 && allocator->used + (nsize - osize) > allocator->limit)
+				return nullptr;
+
+			void *result;
+			if (ptr == nullptr)
+			{
+				// Allocate new block
+				if ((result = allocator->Allocate(nsize)) == nullptr)
+					return nullptr;
+			}
+			else if (osize <= ALLOC_CLASS_MAX && nsize <= ALLOC_CLASS_MAX && SizeClass(osize) == SizeClass(nsize))
+			{
+				// Block already fits the new size
+				result = ptr;
+			}
+			else if (osize > ALLOC_CLASS_MAX && nsize > ALLOC_CLASS_MAX)
+			{
+				// Resize system block
+				if ((result = std::realloc(ptr, nsize)) == nullptr)
+					return nullptr;
+			}
+			else
+			{
+				// Move between size classes
+				if ((result = allocator->Allocate(nsize)) == nullptr)
+					return nullptr;
+				std::memcpy(result, ptr, std::min(osize, nsize));
+				allocator->Free(ptr, osize);
+			}
+
+			// Update accounting
+			allocator->used = allocator->used - osize + nsize;
+			allocator->peak = std::max(allocator->peak, allocator->used);
+			return result;
+		}
+
+		void *Allocator::Allocate(size_t size)
+		{
+			if (size > ALLOC_CLASS_MAX)
+				return std::malloc(size);
+
+			// Pop from size class free list
+			size_t size_class = SizeClass(size);
+			if (free_blocks[size_class] == nullptr && !Refill(size_class))
+				return nullptr;
+
+			FreeBlock *block = free_blocks[size_class];
+			free_blocks[size_class] = block->next;
+			return block;
+		}
+
+		void Allocator::Free(void *ptr, size_t size)
+		{
+			if (size > ALLOC_CLASS_MAX)
+			{
+				std::free(ptr);
+				return;
+			}
+
+			// Push onto size class free list
+			size_t size_class = SizeClass(size);
+			FreeBlock *block = (FreeBlock*)ptr;
+			block->next = free_blocks[size_class];
+			free_blocks[size_class] = block;
+		}
+
+		bool Allocator::Refill(size_t size_class)
+		{
+			// Allocate slab
+			char *slab = (char*)std::malloc(ALLOC_SLAB_SIZE);
+			if (slab == nullptr)
+				return false;
+			slabs.push_back(slab);
+			reserved += ALLOC_SLAB_SIZE;
+
+			// Carve slab into blocks
+			size_t block_size = (size_class + 1) * ALLOC_GRANULE;
+			for (size_t offset = 0; offset + block_size <= ALLOC_SLAB_SIZE; offset += block_size)
+				Free(slab + offset, block_size);
+			return true;
+		}
+	}
+}
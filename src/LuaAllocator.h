@@ -0,0 +1,70 @@
+/*
+ * [PaperPup]
+ *   LuaAllocator.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "Platform/Platform.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		// Allocator constants
+		static constexpr size_t ALLOC_GRANULE = 16;
+		static constexpr size_t ALLOC_CLASS_MAX = 512; // Larger blocks go straight to the system allocator
+		static constexpr size_t ALLOC_CLASSES = ALLOC_CLASS_MAX / ALLOC_GRANULE;
+		static constexpr size_t ALLOC_SLAB_SIZE = 0x10000;
+
+		// Lua state allocator
+		// Each state gets its own allocator and is only touched by the thread running that state, so no locking is needed
+		class Allocator
+		{
+			private:
+				// Free blocks of each size class
+				struct FreeBlock
+				{
+					FreeBlock *next;
+				};
+				FreeBlock *free_blocks[ALLOC_CLASSES] = {};
+
+				// Slabs carved into size class blocks
+				std::vector<void*> slabs;
+
+				// Accounting
+				size_t used = 0, peak = 0, limit;
+				size_t reserved = 0;
+
+			public:
+				// Allocator interface
+				Allocator(size_t _limit) : limit(_limit) {}
+				~Allocator();
+
+				static void *Alloc(void *ud, void *ptr, size_t osize, size_t nsize);
+
+				// Bytes held by Lua, the most it has held, and the bytes taken from the system for slabs
+				size_t Used() const { return used; }
+				size_t Peak() const { return peak; }
+				size_t Limit() const { return limit; }
+				void SetLimit(size_t _limit) { limit = _limit; }
+				size_t Reserved() const { return reserved; }
+
+			private:
+				static size_t SizeClass(size_t size) { return (size - 1) / ALLOC_GRANULE; }
+
+				void *Allocate(size_t size);
+				void Free(void *ptr, size_t size);
+				bool Refill(size_t size_class);
+		};
+	}
+}
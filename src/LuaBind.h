@@ -0,0 +1,226 @@
+/*
+ * [PaperPup]
+ *   LuaBind.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "LuaController.h"
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <limits>
+#include <cmath>
+#include <utility>
+#include <new>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		/*
+			Bind generates lua_CFunction thunks from C++ function signatures at compile time.
+
+			Free functions take their arguments from stack index 1, member functions take
+			their object from index 1 (checked by tag) and their arguments from index 2.
+			Classes must be registered with LuaController::Register<T> before use.
+			A PaperPup::RuntimeError thrown by the function is raised as a Lua error.
+
+			luaL_Reg sprite_meta[] = {
+				Method<&Sprite::SetPosition>("SetPosition"),
+				{ nullptr, nullptr }
+			};
+		*/
+
+		// Argument readers
+		template<typename T, typename = void> struct Arg;
+
+		template<typename T> struct Arg<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+		{
+			static T Get(lua_State *state, int index)
+			{
+				// Luau's luaL_checkinteger truncates to int, so range check the number ourselves before converting
+				double value = luaL_checknumber(state, index);
+				if (value != std::floor(value))
+					luaL_error(state, "bad argument #%d (number has no integer representation)", index);
+				if (!(value >= (double)std::numeric_limits<T>::min() && value < (double)std::numeric_limits<T>::max() + 1.0))
+					luaL_error(state, "bad argument #%d (integer out of range)", index);
+				return (T)value;
+			}
+		};
+
+		template<typename T> struct Arg<T, std::enable_if_t<std::is_enum_v<T>>>
+		{
+			static T Get(lua_State *state, int index) { return (T)Arg<std::underlying_type_t<T>>::Get(state, index); }
+		};
+
+		template<typename T> struct Arg<T, std::enable_if_t<std::is_floating_point_v<T>>>
+		{
+			static T Get(lua_State *state, int index) { return (T)luaL_checknumber(state, index); }
+		};
+
+		template<> struct Arg<bool>
+		{
+			static bool Get(lua_State *state, int index) { return luaL_checkboolean(state, index) != 0; }
+		};
+
+		template<> struct Arg<const char*>
+		{
+			static const char *Get(lua_State *state, int index) { return luaL_checkstring(state, index); }
+		};
+
+		template<> struct Arg<std::string_view>
+		{
+			static std::string_view Get(lua_State *state, int index)
+			{
+				// View into the Lua string, valid while it stays on the stack
+				size_t length;
+				const char *str = luaL_checklstring(state, index, &length);
+				return std::string_view(str, length);
+			}
+		};
+
+		template<typename T> struct Arg<T*, std::enable_if_t<std::is_class_v<T>>>
+		{
+			static T *Get(lua_State *state, int index)
+			{
+				// Tags are registered against the unqualified type
+				using U = std::remove_cv_t<T>;
+				assert(UserdataTag<U>::name != nullptr);
+				return CheckUserdata<U>(state, index, UserdataTag<U>::name);
+			}
+		};
+
+		template<typename T> struct Arg<T&, std::enable_if_t<std::is_class_v<T>>>
+		{
+			static T &Get(lua_State *state, int index) { return *Arg<std::remove_cv_t<T>*>::Get(state, index); }
+		};
+
+		// Result pushers
+		template<typename T> static void Push(lua_State *state, T value)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				lua_pushboolean(state, value);
+			}
+			else if constexpr (std::is_arithmetic_v<T>)
+			{
+				lua_pushnumber(state, (double)value);
+			}
+			else if constexpr (std::is_same_v<T, const char*>)
+			{
+				lua_pushstring(state, value);
+			}
+			else if constexpr (std::is_same_v<T, std::string_view>)
+			{
+				lua_pushlstring(state, value.data(), value.size());
+			}
+			else
+			{
+				// Move class results into new userdata
+				static_assert(std::is_class_v<T>, "Lua::Push unsupported type");
+				assert(UserdataTag<T>::name != nullptr);
+				new (AllocUserdata<T>(state, UserdataTag<T>::name)) T(std::move(value));
+			}
+		}
+
+		// Function thunks
+		template<typename F, F function> struct Thunk;
+
+		template<typename R, typename... Args, R (*function)(Args...)> struct Thunk<R (*)(Args...), function>
+		{
+			template<size_t... I> static int Call(lua_State *state, std::index_sequence<I...>)
+			{
+				if constexpr (std::is_void_v<R>)
+				{
+					function(Arg<Args>::Get(state, (int)I + 1)...);
+					return 0;
+				}
+				else
+				{
+					Push<std::decay_t<R>>(state, function(Arg<Args>::Get(state, (int)I + 1)...));
+					return 1;
+				}
+			}
+
+			static int Function(lua_State *state)
+			{
+				return Call(state, std::index_sequence_for<Args...>{});
+			}
+		};
+
+		template<typename C, typename R, typename... Args, R (C::*function)(Args...)> struct Thunk<R (C::*)(Args...), function>
+		{
+			template<size_t... I> static int Call(lua_State *state, std::index_sequence<I...>)
+			{
+				C *object = Arg<C*>::Get(state, 1);
+				if constexpr (std::is_void_v<R>)
+				{
+					(object->*function)(Arg<Args>::Get(state, (int)I + 2)...);
+					return 0;
+				}
+				else
+				{
+					Push<std::decay_t<R>>(state, (object->*function)(Arg<Args>::Get(state, (int)I + 2)...));
+					return 1;
+				}
+			}
+
+			static int Function(lua_State *state)
+			{
+				return Call(state, std::index_sequence_for<Args...>{});
+			}
+		};
+
+		template<typename C, typename R, typename... Args, R (C::*function)(Args...) const> struct Thunk<R (C::*)(Args...) const, function>
+		{
+			template<size_t... I> static int Call(lua_State *state, std::index_sequence<I...>)
+			{
+				const C *object = Arg<C*>::Get(state, 1);
+				if constexpr (std::is_void_v<R>)
+				{
+					(object->*function)(Arg<Args>::Get(state, (int)I + 2)...);
+					return 0;
+				}
+				else
+				{
+					Push<std::decay_t<R>>(state, (object->*function)(Arg<Args>::Get(state, (int)I + 2)...));
+					return 1;
+				}
+			}
+
+			static int Function(lua_State *state)
+			{
+				return Call(state, std::index_sequence_for<Args...>{});
+			}
+		};
+
+		// Binding interface
+		template<auto function> static int Bind(lua_State *state)
+		{
+			// Engine exceptions can't unwind through Luau frames, so raise them as Lua errors
+			std::string error;
+			try
+			{
+				return Thunk<decltype(function), function>::Function(state);
+			}
+			catch (PaperPup::RuntimeError &exception)
+			{
+				error = exception.what();
+			}
+			luaL_error(state, "%s", error.c_str());
+		}
+
+		template<auto function> static constexpr luaL_Reg Method(const char *name)
+		{
+			return { name, &Bind<function> };
+		}
+	}
+}
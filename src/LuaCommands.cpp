@@ -0,0 +1,156 @@
+/*
+ * [PaperPup]
+ *   LuaCommands.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "LuaCommands.h"
+
+#include "LuaController.h"
+
+#include <luacode.h>
+
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		// Command append function, called with the buffer, the flush function, and the capacity
+		static const char command_append_source[] = R"(
+local buf, flush, capacity = ...
+local readf64, writef64 = buffer.readf64, buffer.writef64
+
+return function(op, a, b, c, d)
+	local n = readf64(buf, 0)
+	if n >= capacity then
+		flush()
+		n = 0
+	end
+
+	local offset = 8 + n * 40
+	writef64(buf, offset, op)
+	writef64(buf, offset + 8, a or 0)
+	writef64(buf, offset + 16, b or 0)
+	writef64(buf, offset + 24, c or 0)
+	writef64(buf, offset + 32, d or 0)
+	writef64(buf, 0, n + 1)
+end
+)";
+
+		// Command buffer interface
+		CommandBuffer::CommandBuffer(lua_State *_state) : state(_state)
+		{
+			// Create buffer
+			size_t buffer_size = 8 + (size_t)COMMAND_CAPACITY * COMMAND_STRIDE * 8;
+			buffer_data = (char*)lua_newbuffer(state, buffer_size);
+			std::memset(buffer_data, 0, buffer_size);
+			buffer_ref = lua_ref(state, -1);
+
+			// Compile append function
+			lua_CompileOptions options{};
+			options.optimizationLevel = 2;
+
+			size_t bytecode_size;
+			std::unique_ptr<char, decltype(&std::free)> bytecode(luau_compile(command_append_source, sizeof(command_append_source) - 1, &options, &bytecode_size), &std::free);
+			if (bytecode == nullptr || luau_load(state, "=CommandBuffer", bytecode.get(), bytecode_size, 0) != 0)
+				throw PaperPup::RuntimeError("Failed to load command buffer");
+
+			// Make append function
+			lua_pushvalue(state, -2);
+			lua_pushlightuserdata(state, this);
+			lua_pushcclosure(state, [](lua_State *state)
+			{
+				// Dispatch early once the buffer fills up
+				((CommandBuffer*)lua_touserdata(state, lua_upvalueindex(1)))->Dispatch();
+				return 0;
+			}, "flush", 1);
+			lua_pushnumber(state, COMMAND_CAPACITY);
+			ProtectedCall(state, 3, 1);
+
+			append_ref = lua_ref(state, -1);
+			lua_pop(state, 2);
+		}
+
+		CommandBuffer::~CommandBuffer()
+		{
+			// Release Lua objects
+			lua_unref(state, append_ref);
+			lua_unref(state, buffer_ref);
+		}
+
+		unsigned int CommandBuffer::AddOp(std::string name, CommandHandler handler)
+		{
+			// Replace existing op or add new one
+			auto op = op_map.find(name);
+			if (op != op_map.end())
+			{
+				handlers[op->second] = handler;
+				return op->second;
+			}
+
+			unsigned int id = (unsigned int)handlers.size();
+			handlers.push_back(handler);
+			op_map.emplace(name, id);
+			return id;
+		}
+
+		void CommandBuffer::Dispatch()
+		{
+			// Read command count
+			double count_value;
+			std::memcpy(&count_value, buffer_data, 8);
+			size_t count = (size_t)count_value;
+			if (count > COMMAND_CAPACITY)
+				count = COMMAND_CAPACITY;
+
+			// Run commands
+			double command[COMMAND_STRIDE];
+			for (size_t i = 0; i < count; i++)
+			{
+				std::memcpy(command, buffer_data + 8 + i * COMMAND_STRIDE * 8, sizeof(command));
+				size_t op = (size_t)command[0];
+				if (command[0] >= 0.0 && op < handlers.size() && handlers[op])
+					handlers[op](command + 1);
+			}
+
+			// Clear buffer
+			std::memset(buffer_data, 0, 8);
+		}
+
+		// Lua commands library
+		void RegisterCommands(LuaController &lua)
+		{
+			static luaL_Reg lib_commands[] = {
+				{"get", [](lua_State *state)
+				{
+					// Return our controller's append function
+					LuaController::Get(state)->Commands().PushAppend(state);
+					return 1;
+				}},
+				{"op", [](lua_State *state)
+				{
+					// Return op id for name, or nil if the engine doesn't handle it
+					int op = LuaController::Get(state)->Commands().FindOp(luaL_checkstring(state, 1));
+					if (op < 0)
+						lua_pushnil(state);
+					else
+						lua_pushnumber(state, op);
+					return 1;
+				}},
+				{nullptr, nullptr}
+			};
+			static luaL_Reg meta_commands[] = {
+				{nullptr, nullptr}
+			};
+			lua.Register("Commands", lib_commands, meta_commands);
+		}
+	}
+}
@@ -0,0 +1,80 @@
+/*
+ * [PaperPup]
+ *   LuaCommands.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "Platform/Platform.h"
+
+#include <lua.h>
+#include <lualib.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		// Command buffer constants
+		static constexpr unsigned int COMMAND_STRIDE = 5; // Op and four arguments
+		static constexpr unsigned int COMMAND_CAPACITY = 0x1000;
+
+		/*
+			Command Buffer Structure (Luau buffer, all values are doubles):
+			   0 - Command count
+			   8 - Commands (op, a, b, c, d)
+		*/
+
+		// Command buffer
+		// Scripts append commands with a pure Lua function, so building a frame's commands never crosses into C++
+		using CommandHandler = std::function<void(const double *args)>;
+
+		class CommandBuffer
+		{
+			private:
+				// Lua objects, held in the registry
+				lua_State *state;
+				int buffer_ref, append_ref;
+				char *buffer_data;
+
+				// Op handlers
+				std::vector<CommandHandler> handlers;
+				std::unordered_map<std::string, unsigned int> op_map;
+
+			public:
+				// Command buffer interface
+				CommandBuffer(lua_State *_state);
+				~CommandBuffer();
+
+				unsigned int AddOp(std::string name, CommandHandler handler);
+				int FindOp(const std::string &name) const
+				{
+					auto op = op_map.find(name);
+					return (op != op_map.end()) ? (int)op->second : -1;
+				}
+
+				// Pushes the append function, append(op, a, b, c, d)
+				void PushAppend(lua_State *to)
+				{
+					lua_getref(to, append_ref);
+				}
+
+				// Runs and clears appended commands
+				void Dispatch();
+		};
+
+		// Lua commands library
+		class LuaController;
+		void RegisterCommands(LuaController &lua);
+	}
+}
@@ -10,10 +10,30 @@
 */
 
 #include "LuaController.h"
+#include "LuaFilesystem.h"
 
 #include "Engine.h"
 
-#include <Luau/Compiler.h>
+#include "Platform/Userdata.h"
+#include "Platform/Common/Hash.h"
+#include "Platform/Common/Bundle.h"
+
+#include <luacode.h>
+
+#ifdef PAPERPUP_LUAU_CODEGEN
+	#include <Luau/CodeGen.h>
+#endif
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
 
 // Lua libraries
 
@@ -21,38 +41,220 @@ namespace PaperPup
 {
 	namespace Lua
 	{
-		// Lua functions
-		static int Lua_RequireCompile(lua_State *state, std::string source, std::string name)
+		// Bytecode cache constants
+		static constexpr uint32_t BYTECODE_CACHE_MAGIC = 0x3043424C; // "LBC0"
+
+		// Bytecode cache, shared by all controllers
+		static std::mutex bytecode_cache_mutex;
+		static std::unordered_map<uint64_t, std::shared_ptr<const std::string>> bytecode_cache;
+
+		static uint64_t Lua_BytecodeKey(const char *source, size_t source_size, const lua_CompileOptions &options)
 		{
-			// Create new thread for module
-			lua_State *main_thread = lua_mainthread(state);
-			lua_State *module_thread = lua_newthread(main_thread);
-			lua_xmove(main_thread, state, 1);
+			// Key on source and every compile option that affects bytecode
+			uint64_t hash = Hash::FNV1a(source, source_size);
+			hash = Hash::FNV1a((uint32_t)options.optimizationLevel, hash);
+			hash = Hash::FNV1a((uint32_t)options.debugLevel, hash);
+			hash = Hash::FNV1a((uint32_t)options.coverageLevel, hash);
+			return Hash::FNV1a((uint32_t)source_size, hash);
+		}
 
-			luaL_sandboxthread(module_thread);
+		static lua_CompileOptions Lua_CompileOptions()
+		{
+			// Optimization level 2 also enables function inlining and loop unrolling
+			lua_CompileOptions options{};
+			options.optimizationLevel = std::clamp(Userdata::GetInteger("lua/optimization_level", 1), 0, 2);
+			options.debugLevel = std::clamp(Userdata::GetInteger("lua/debug_level", 1), 0, 2);
+			return options;
+		}
 
-			// Compile and execute bytecode
-			std::string chunkname = "=" + name;
-			std::string bytecode = Luau::compile(source, Luau::CompileOptions{});
-			if (luau_load(module_thread, chunkname.c_str(), bytecode.data(), bytecode.size(), 0) == 0)
+		static bool Lua_NativeEnabled()
+		{
+			#ifdef PAPERPUP_LUAU_CODEGEN
+				return Luau::CodeGen::isSupported() && Userdata::GetBool("lua/native_enabled", true);
+			#else
+				return false;
+			#endif
+		}
+
+		static std::shared_ptr<const std::string> Lua_Compile(const char *source, size_t source_size, bool *cached, bool recompile = false)
+		{
+			lua_CompileOptions options = Lua_CompileOptions();
+			uint64_t key = Lua_BytecodeKey(source, source_size, options);
+
+			char key_name[17];
+			std::snprintf(key_name, sizeof(key_name), "%016llx", (unsigned long long)key);
+			std::string cache_path = "Cache/Luau/" + std::string(key_name) + ".bin";
+
+			/*
+				Bytecode Cache Structure:
+				   0 - Magic ("LBC0")
+				   4 - Key (64-bit)
+				   C - Bytecode
+			*/
+			if (!recompile)
 			{
-				int status = lua_resume(module_thread, state, 0);
-				if (status == 0)
+				// Look in memory cache
 				{
-					if (lua_gettop(module_thread) == 0)
-						throw PaperPup::RuntimeError("No return value from module " + name);
+					std::lock_guard<std::mutex> lock(bytecode_cache_mutex);
+					auto entry = bytecode_cache.find(key);
+					if (entry != bytecode_cache.end())
+					{
+						*cached = true;
+						return entry->second;
+					}
 				}
-				else if (status == LUA_YIELD)
+
+				// Look in disk cache
+				std::vector<char> cache;
+				if (Filesystem::ReadLocal(cache_path, cache) && cache.size() > 0xC &&
+					Filesystem::Read32(cache.data() + 0x0) == BYTECODE_CACHE_MAGIC &&
+					((uint64_t)Filesystem::Read32(cache.data() + 0x4) | ((uint64_t)Filesystem::Read32(cache.data() + 0x8) << 32)) == key)
 				{
-					throw PaperPup::RuntimeError("Yield requiring module " + name);
+					auto bytecode = std::make_shared<const std::string>(cache.data() + 0xC, cache.size() - 0xC);
+
+					std::lock_guard<std::mutex> lock(bytecode_cache_mutex);
+					bytecode_cache[key] = bytecode;
+					*cached = true;
+					return bytecode;
 				}
+			}
+
+			// Compile source straight from the caller's buffer
+			size_t bytecode_size;
+			std::unique_ptr<char, decltype(&std::free)> bytecode_data(luau_compile(source, source_size, &options, &bytecode_size), &std::free);
+			if (bytecode_data == nullptr)
+				throw PaperPup::RuntimeError("Failed to compile Luau source");
+
+			auto bytecode = std::make_shared<const std::string>(bytecode_data.get(), bytecode_size);
+			*cached = false;
+
+			// Failed compiles are encoded with a leading zero, and are left out of the cache
+			if (bytecode->empty() || (*bytecode)[0] == 0)
+				return bytecode;
+
+			{
+				std::lock_guard<std::mutex> lock(bytecode_cache_mutex);
+				bytecode_cache[key] = bytecode;
+			}
+
+			std::vector<char> cache;
+			for (uint32_t value : { BYTECODE_CACHE_MAGIC, (uint32_t)(key >> 0), (uint32_t)(key >> 32) })
+			{
+				cache.push_back(value >> 0); cache.push_back(value >> 8); cache.push_back(value >> 16); cache.push_back(value >> 24);
+			}
+			cache.insert(cache.end(), bytecode->begin(), bytecode->end());
+			Filesystem::WriteLocal(cache_path, cache);
+
+			return bytecode;
+		}
+
+		// Userdata tags, shared by all controllers so a class keeps its tag everywhere
+		static std::mutex userdata_tag_mutex;
+		static std::unordered_map<std::string, int> userdata_tags;
+
+		static int Lua_UserdataTag(const char *name)
+		{
+			std::lock_guard<std::mutex> lock(userdata_tag_mutex);
+
+			// Get existing tag
+			auto tag = userdata_tags.find(name);
+			if (tag != userdata_tags.end())
+				return tag->second;
+
+			// Assign next tag, tag 0 is left for untagged userdata
+			int next_tag = (int)userdata_tags.size() + 1;
+			if (next_tag >= LUA_UTAG_LIMIT)
+				return -1;
+			userdata_tags.emplace(name, next_tag);
+			return next_tag;
+		}
+
+		// Watchdog constants
+		static constexpr unsigned int WATCHDOG_CHECK_INTERVAL = 0x100; // Interrupts between clock reads
+
+		// Garbage collection constants
+		static constexpr int GC_STEP_KB = 8;
+		static constexpr size_t GC_HEAP_GROWTH = 2; // Start a new cycle once the heap doubles since the last
+		static constexpr size_t GC_HEAP_EMERGENCY = 4; // Collect everything at once if the heap quadruples
+
+		// Profiler names, numbered so controllers with the same name don't overwrite each other
+		static std::atomic<unsigned int> profiler_index{0};
+
+		static std::string Lua_ProfileName(const std::string &name)
+		{
+			// Keep names usable as file names
+			std::string result;
+			for (char c : name)
+				result += (std::isalnum((unsigned char)c) || c == '.' || c == '-') ? c : '_';
+			if (result.empty())
+				result = "Lua";
+			return result + "." + std::to_string(profiler_index++);
+		}
+
+		// Template controller of each thread
+		static thread_local std::unique_ptr<LuaController> template_controller;
+
+		// Lua functions
+		static void Lua_Interrupt(lua_State *state, int gc)
+		{
+			// Dispatch to the controller owning this thread
+			LuaController::Get(state)->Interrupt(state, gc);
+		}
+
+		static void Lua_UserThread(lua_State *parent, lua_State *thread)
+		{
+			// New threads belong to the controller of the thread that created them
+			if (parent != nullptr)
+				lua_setthreaddata(thread, lua_getthreaddata(parent));
+		}
+
+		static bool Lua_RequireLoad(lua_State *state, const char *bytecode, size_t bytecode_size, std::string name, std::string *error = nullptr)
+		{
+			// Create new thread for module from our controller's thread, so it sees the controller's globals
+			lua_State *controller_thread = LuaController::Get(state)->global_state;
+			lua_State *module_thread = lua_newthread(controller_thread);
+			lua_xmove(controller_thread, state, 1);
+
+			luaL_sandboxthread(module_thread);
+
+			// Load bytecode
+			std::string chunkname = "=" + name;
+			if (luau_load(module_thread, chunkname.c_str(), bytecode, bytecode_size, 0) != 0)
+			{
+				// Discard module thread
+				if (error != nullptr && lua_isstring(module_thread, -1))
+					*error = lua_tostring(module_thread, -1);
+				lua_pop(state, 1);
+				return false;
+			}
+
+			#ifdef PAPERPUP_LUAU_CODEGEN
+				// Compile functions of modules marked --!native to native code
+				if (Lua_NativeEnabled())
+					Luau::CodeGen::compile(module_thread, -1, Luau::CodeGen::CodeGen_OnlyNativeModules);
+			#endif
+
+			// Execute module
+			int status;
+			{
+				WatchdogScope watchdog(module_thread);
+				status = lua_resume(module_thread, state, 0);
+			}
+			if (status == 0)
+			{
+				if (lua_gettop(module_thread) == 0)
+					throw PaperPup::RuntimeError("No return value from module " + name);
+			}
+			else if (status == LUA_YIELD)
+			{
+				throw PaperPup::RuntimeError("Yield requiring module " + name);
+			}
+			else
+			{
+				if (lua_isstring(module_thread, -1))
+					throw PaperPup::RuntimeError("Error requiring " + name + ": " + lua_tostring(module_thread, -1));
 				else
-				{
-					if (lua_isstring(module_thread, -1))
-						throw PaperPup::RuntimeError("Error requiring " + name + ": " + lua_tostring(module_thread, -1));
-					else
-						throw PaperPup::RuntimeError("Error requiring " + name);
-				}
+					throw PaperPup::RuntimeError("Error requiring " + name);
 			}
 
 			// Module thread stack contains our module, so we need to transfer the module to our main state
@@ -64,27 +266,94 @@ namespace PaperPup
 			lua_setfield(state, -3, name.c_str());
 			lua_remove(state, -2);
 
+			// The loaded module is on top of the stack
+			return true;
+		}
+
+		static int Lua_RequireCompile(lua_State *state, const char *source, size_t source_size, std::string name)
+		{
+			// Compile and execute bytecode, compiling a nested require doesn't count against the requiring script's budget
+			bool cached;
+			std::shared_ptr<const std::string> bytecode;
+			{
+				WatchdogPause watchdog(state);
+				bytecode = Lua_Compile(source, source_size, &cached);
+			}
+
+			std::string error;
+			if (!Lua_RequireLoad(state, bytecode->data(), bytecode->size(), name, &error))
+			{
+				// Cached bytecode may have been built by another Luau version, so try again with a fresh compile
+				if (!cached)
+					throw PaperPup::RuntimeError("Error compiling " + name + ": " + error);
+
+				{
+					WatchdogPause watchdog(state);
+					bytecode = Lua_Compile(source, source_size, &cached, true);
+				}
+				if (!Lua_RequireLoad(state, bytecode->data(), bytecode->size(), name, &error))
+					throw PaperPup::RuntimeError("Error compiling " + name + ": " + error);
+			}
+
 			// Return the loaded module
 			return 1;
 		}
 
-		static int Lua_RequireSource(lua_State *state, std::string source, std::string name)
+		static bool Lua_FindModule(lua_State *state, std::string name)
 		{
-			// This function is called from C++ as well, so we should leave the stack clean
-
-			// Look for module in cache
-			luaL_findtable(state, LUA_REGISTRYINDEX, "_MODULES", 1);
+			// Look for module in our controller's cache, which falls back to its template's
+			LuaController::Get(state)->PushModules(state);
 			lua_getfield(state, -1, name.c_str());
 			if (!lua_isnil(state, -1))
 			{
 				// Return the found module
 				lua_remove(state, -2);
-				return 1;
+				return true;
 			}
 			lua_pop(state, 1);
 
+			// _MODULES is left on the stack for the loader
+			return false;
+		}
+
+		static int Lua_RequireSource(lua_State *state, const char *source, size_t source_size, std::string name)
+		{
+			// This function is called from C++ as well, so we should leave the stack clean
+
+			// Look for module in cache
+			if (Lua_FindModule(state, name))
+				return 1;
+
 			// Compile source
-			return Lua_RequireCompile(state, source, name);
+			return Lua_RequireCompile(state, source, source_size, name);
+		}
+
+		static bool Lua_BundledBytecode(const char *&bytecode, size_t &bytecode_size)
+		{
+			// Bundled bytecode is only usable if it was compiled with our options
+			lua_CompileOptions options = Lua_CompileOptions();
+			if (bytecode_size < Filesystem::BUNDLE_BYTECODE_HEADER || bytecode[0] != options.optimizationLevel || bytecode[1] != options.debugLevel)
+				return false;
+			bytecode += Filesystem::BUNDLE_BYTECODE_HEADER;
+			bytecode_size -= Filesystem::BUNDLE_BYTECODE_HEADER;
+			return true;
+		}
+
+		static bool Lua_RequireBytecode(lua_State *state, const char *bytecode, size_t bytecode_size, std::string name)
+		{
+			// This function is called from C++ as well, so we should leave the stack clean
+
+			// Look for module in cache
+			if (Lua_FindModule(state, name))
+				return true;
+
+			// Load bytecode, which may fail if it was built for another Luau version or with other options
+			if (Lua_BundledBytecode(bytecode, bytecode_size) && Lua_RequireLoad(state, bytecode, bytecode_size, name))
+				return true;
+
+			// Pop _MODULES
+			lua_pop(state, 1);
+			return false;
 		}
 
 		static int Lua_Require(lua_State *state, std::string name)
@@ -92,42 +361,72 @@ namespace PaperPup
 			// This function is called from C++ as well, so we should leave the stack clean
 			
 			// Look for module in cache
-			luaL_findtable(state, LUA_REGISTRYINDEX, "_MODULES", 1);
-			lua_getfield(state, -1, name.c_str());
-			if (!lua_isnil(state, -1))
-			{
-				// Return the found module
-				lua_remove(state, -2);
+			if (Lua_FindModule(state, name))
 				return 1;
-			}
-			lua_pop(state, 1);
 
-			// Load source for module
-			std::unique_ptr<char[]> source;
-			size_t source_size;
+			// Use precompiled bytecode for module if available
 			{
-				// Open source file
-				std::unique_ptr<Filesystem::File> source_file(g_engine->OpenFile(name, false));
-				if (source_file == nullptr)
-					throw PaperPup::RuntimeError("Failed to open source for module " + name);
-
-				// Read source file
-				source.reset(source_file->Dup());
-				source_size = source_file->Size();
+				std::unique_ptr<Filesystem::File> bytecode_file(g_engine->OpenBytecode(name));
+				if (bytecode_file != nullptr)
+				{
+					const char *bytecode = bytecode_file->Data();
+					size_t bytecode_size = bytecode_file->Size();
+					if (Lua_BundledBytecode(bytecode, bytecode_size) && Lua_RequireLoad(state, bytecode, bytecode_size, name))
+						return 1;
+				}
 			}
 
-			// Compile source
-			return Lua_RequireCompile(state, std::string(source.get(), source_size), name);
+			// Open source file
+			std::unique_ptr<Filesystem::File> source_file(g_engine->OpenFile(name, false));
+			if (source_file == nullptr)
+				throw PaperPup::RuntimeError("Failed to open source for module " + name);
+
+			// Compile source in place
+			return Lua_RequireCompile(state, source_file->Data(), source_file->Size(), name);
+		}
+
+		static void Lua_Freeze(lua_State *state, int index, std::unordered_set<const void*> &frozen)
+		{
+			// Make table and every table reachable from it read-only
+			if (!lua_istable(state, index) || !frozen.insert(lua_topointer(state, index)).second)
+				return;
+			index = (index < 0) ? (lua_gettop(state) + index + 1) : index;
+
+			lua_pushnil(state);
+			while (lua_next(state, index))
+			{
+				Lua_Freeze(state, -2, frozen);
+				Lua_Freeze(state, -1, frozen);
+				lua_pop(state, 1);
+			}
+			if (lua_getmetatable(state, index))
+			{
+				Lua_Freeze(state, -1, frozen);
+				lua_pop(state, 1);
+			}
+			lua_setreadonly(state, index, 1);
 		}
 
 		// Lua controller interface
-		LuaController::LuaController()
+		LuaController::LuaController(bool _frame_driven) : frame_driven(_frame_driven)
 		{
-			// Open global state
-			if ((global_state = luaL_newstate()) == nullptr)
+			// Open global state with a pooled allocator, capped at lua/memory_limit MiB (0 for no limit)
+			allocator_owned = std::make_unique<Allocator>((size_t)std::max(Userdata::GetInteger("lua/memory_limit", 256), 0) << 20);
+			allocator = allocator_owned.get();
+			if ((global_state = lua_newstate(Allocator::Alloc, allocator)) == nullptr)
 				throw PaperPup::RuntimeError("Failed to open Luau global state");
 			luaL_openlibs(global_state);
 
+			// Threads find their controller through thread data
+			lua_setthreaddata(global_state, this);
+			lua_callbacks(global_state)->userthread = Lua_UserThread;
+
+			// Create native code generator
+			#ifdef PAPERPUP_LUAU_CODEGEN
+				if (Lua_NativeEnabled())
+					Luau::CodeGen::create(global_state);
+			#endif
+
 			// Register global methods
 			static const luaL_Reg lib_global[] = {
 				{"require", [](lua_State *state)
@@ -136,6 +435,53 @@ namespace PaperPup
 					std::string name = luaL_checkstring(state, 1);
 					return Lua_Require(state, name);
 				}},
+				{"wait", [](lua_State *state)
+				{
+					// Yield until a number of frames have passed
+					return LuaController::Get(state)->WaitFrames(state, luaL_optnumber(state, 1, 1.0));
+				}},
+				{"waitBeat", [](lua_State *state)
+				{
+					// Yield until a number of beats have passed
+					return LuaController::Get(state)->WaitBeats(state, luaL_checknumber(state, 1));
+				}},
+				{"waitEvent", [](lua_State *state)
+				{
+					// Yield until an event, such as an asset load, is signalled
+					return LuaController::Get(state)->WaitEvent(state, (uint64_t)luaL_checknumber(state, 1));
+				}},
+				{"spawn", [](lua_State *state)
+				{
+					// Run function on a new thread until it first waits
+					luaL_checktype(state, 1, LUA_TFUNCTION);
+					int nargs = lua_gettop(state) - 1;
+
+					lua_State *thread = lua_newthread(state);
+					lua_insert(state, 1);
+
+					// Mark thread as the scheduler's, so it may wait
+					lua_getref(state, LuaController::Get(state)->spawned_ref);
+					lua_pushvalue(state, 1);
+					lua_pushboolean(state, 1);
+					lua_rawset(state, -3);
+					lua_pop(state, 1);
+					lua_xmove(state, thread, nargs + 1);
+
+					int status;
+					{
+						WatchdogScope watchdog(thread);
+						status = lua_resume(thread, state, nargs);
+					}
+					if (status != LUA_OK && status != LUA_YIELD)
+					{
+						// Raise the thread's error in the spawner
+						lua_xmove(thread, state, 1);
+						lua_error(state);
+					}
+
+					// Return the thread
+					return 1;
+				}},
 				{nullptr, nullptr}
 			};
 
@@ -144,16 +490,480 @@ namespace PaperPup
 			lua_pop(global_state, 1);
 
 			// Register libraries
+			RegisterFilesystem(*this);
+			RegisterCommands(*this);
 
 			// Sandbox global state
 			luaL_sandbox(global_state);
+
+			// Create module cache
+			lua_newtable(global_state);
+			modules_ref = lua_ref(global_state, -1);
+			lua_pop(global_state, 1);
+
+			Init();
+		}
+
+		LuaController::LuaController(LuaController &_parent) : allocator(_parent.allocator), parent(&_parent), frame_driven(false)
+		{
+			// Take a memory category of our own, so we're accounted and capped apart from our siblings
+			lua_State *parent_state = parent->global_state;
+			if (!parent->memcats_free.empty())
+			{
+				memcat = parent->memcats_free.back();
+				parent->memcats_free.pop_back();
+
+				// Collect what the category's last owner left behind before counting it as ours
+				if (lua_totalbytes(parent_state, memcat) != 0)
+					lua_gc(parent_state, LUA_GCCOLLECT, 0);
+			}
+			else if (parent->memcat_next < LUA_MEMORY_CATEGORIES)
+			{
+				memcat = parent->memcat_next++;
+			}
+			else
+			{
+				throw PaperPup::RuntimeError("Too many Lua controllers made from one template");
+			}
+			memory_limit = (size_t)std::max(Userdata::GetInteger("lua/memory_limit", 256), 0) << 20;
+
+			// Create our thread from the template, held by the template's registry
+			// Threads inherit their creator's category, so everything our scripts allocate is counted as ours
+			global_state = lua_newthread(parent_state);
+			lua_setmemcat(global_state, memcat);
+			thread_ref = lua_ref(parent_state, -1);
+			lua_pop(parent_state, 1);
+
+			lua_setthreaddata(global_state, this);
+
+			// Sandbox our globals, reading through to the template's
+			luaL_sandboxthread(global_state);
+
+			// Create module cache, reading through to the template's
+			lua_newtable(global_state);
+			lua_newtable(global_state);
+			parent->PushModules(global_state);
+			lua_setfield(global_state, -2, "__index");
+			lua_setmetatable(global_state, -2);
+			modules_ref = lua_ref(global_state, -1);
+			lua_pop(global_state, 1);
+
+			Init();
+		}
+
+		void LuaController::Init()
+		{
+			// Create spawned thread set
+			lua_newtable(global_state);
+			lua_newtable(global_state);
+			lua_pushstring(global_state, "k");
+			lua_setfield(global_state, -2, "__mode");
+			lua_setmetatable(global_state, -2);
+			spawned_ref = lua_ref(global_state, -1);
+			lua_pop(global_state, 1);
+
+			// Get watchdog budgets, 0 disables a budget
+			watchdog_resume_us = std::max(Userdata::GetInteger("lua/watchdog_resume_ms", 1000), 0) * 1000.0;
+			watchdog_frame_us = std::max(Userdata::GetInteger("lua/watchdog_frame_ms", 100), 0) * 1000.0;
+
+			// Frame driven controllers only collect when the engine steps them
+			if (frame_driven)
+			{
+				lua_gc(global_state, LUA_GCSTOP, 0);
+				gc_heap_base = allocator->Used();
+				g_engine->AttachLua(this);
+			}
+
+			// Only take interrupts when something uses them, they're called at every safepoint
+			// Controllers made from a template read the same budgets, so the template's callback serves them too
+			bool profiler_enabled = Userdata::GetBool("lua/profiler_enabled", false);
+			if (parent == nullptr && (watchdog_resume_us != 0.0 || watchdog_frame_us != 0.0 || profiler_enabled))
+				lua_callbacks(global_state)->interrupt = Lua_Interrupt;
+
+			// Profile controller if requested
+			if (profiler_enabled)
+				StartProfiler("", Userdata::GetInteger("lua/profiler_interval_us", 1000));
 		}
 
 		LuaController::~LuaController()
 		{
-			// Close global state
-			if (global_state != nullptr)
-				lua_close(global_state);
+			// Stop being stepped by the engine
+			if (frame_driven)
+				g_engine->DetachLua(this);
+
+			// Write profile
+			StopProfiler();
+
+			// Release command buffer before our thread
+			commands.reset();
+
+			if (parent != nullptr)
+			{
+				// Release waiting threads, our modules, and our thread back to the template
+				for (; !wait_frames.empty(); wait_frames.pop())
+					lua_unref(global_state, wait_frames.top().thread_ref);
+				for (; !wait_beats.empty(); wait_beats.pop())
+					lua_unref(global_state, wait_beats.top().thread_ref);
+				for (auto &waiting : wait_events)
+				{
+					for (int waiting_ref : waiting.second)
+						lua_unref(global_state, waiting_ref);
+				}
+
+				lua_settop(global_state, 0);
+				lua_unref(global_state, spawned_ref);
+				lua_unref(global_state, modules_ref);
+				lua_unref(parent->global_state, thread_ref);
+
+				// Give our category back to the template
+				parent->memcats_free.push_back(memcat);
+			}
+			else
+			{
+				// Close global state
+				if (global_state != nullptr)
+					lua_close(global_state);
+			}
+		}
+
+		LuaController &LuaController::Template()
+		{
+			// A Luau state can only be used by one thread at a time, so each thread keeps its own template
+			LuaController *lua_template = template_controller.get();
+			if (lua_template == nullptr)
+			{
+				template_controller = std::make_unique<LuaController>();
+				lua_template = template_controller.get();
+				lua_template->SetName("Template");
+
+				// Controllers made from the template are capped on their own, the template isn't
+				lua_template->allocator->SetLimit(0);
+
+				// Preload common modules named in lua/template_modules, separated by spaces
+				std::istringstream modules(Userdata::GetString("lua/template_modules", ""));
+				std::string module;
+				// Template modules are shared by every controller on this thread, so freeze them to keep packs from leaking state into each other
+				std::unordered_set<const void*> frozen;
+				while (modules >> module)
+				{
+					lua_template->Require(module);
+					Lua_Freeze(lua_template->global_state, -1, frozen);
+					lua_pop(lua_template->global_state, 1);
+				}
+			}
+			return *lua_template;
+		}
+
+		void LuaController::ReleaseTemplate()
+		{
+			// Every controller made from the template must already be gone
+			template_controller.reset();
+		}
+
+		void LuaController::StepGC(double budget_us)
+		{
+			using Clock = std::chrono::steady_clock;
+
+			auto Elapsed = [](Clock::time_point start)
+			{
+				return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+			};
+
+			Clock::time_point frame_start = Clock::now();
+			size_t heap = allocator->Used();
+
+			if (heap > std::max(gc_heap_base, (size_t)1) * GC_HEAP_EMERGENCY || (allocator->Limit() != 0 && heap > allocator->Limit() / 4 * 3))
+			{
+				// The heap has outgrown our steps, so collect everything now rather than run out of memory
+				lua_gc(global_state, LUA_GCCOLLECT, 0);
+				gc_cycle = false;
+				gc_heap_base = allocator->Used();
+
+				gc_stats.emergencies++;
+				gc_stats.cycles++;
+				gc_stats.pause_max_us = std::max(gc_stats.pause_max_us, Elapsed(frame_start));
+			}
+			else if (gc_cycle || heap > gc_heap_base * GC_HEAP_GROWTH)
+			{
+				// Step collector until the cycle finishes or the budget runs out
+				gc_cycle = true;
+				do
+				{
+					Clock::time_point step_start = Clock::now();
+					bool finished = lua_gc(global_state, LUA_GCSTEP, GC_STEP_KB) != 0;
+					gc_stats.steps++;
+					gc_stats.pause_max_us = std::max(gc_stats.pause_max_us, Elapsed(step_start));
+
+					if (finished)
+					{
+						gc_cycle = false;
+						gc_heap_base = allocator->Used();
+						gc_stats.cycles++;
+						break;
+					}
+				} while (Elapsed(frame_start) < budget_us);
+
+				// Stepping moves the collector threshold, so keep it from collecting on its own
+				lua_gc(global_state, LUA_GCSTOP, 0);
+			}
+
+			gc_stats.step_us = Elapsed(frame_start);
+			gc_stats.heap_bytes = allocator->Used();
+		}
+
+		FieldHandle LuaController::Field(const std::string &name)
+		{
+			// Controllers made from a template share its handles
+			if (parent != nullptr)
+				return parent->Field(name);
+
+			// Get existing handle
+			auto field = field_refs.find(name);
+			if (field == field_refs.end())
+			{
+				// Intern name into registry
+				lua_pushlstring(global_state, name.data(), name.size());
+				field = field_refs.emplace(name, lua_ref(global_state, -1)).first;
+				lua_pop(global_state, 1);
+			}
+			return { field->second, field->first.c_str() };
+		}
+
+		void LuaController::StartProfiler(std::string _profiler_name, unsigned int interval_us)
+		{
+			// Start sampling on interrupts
+			StopProfiler();
+			lua_callbacks(global_state)->interrupt = Lua_Interrupt;
+			profiler = std::make_unique<Profiler>(std::max(interval_us, 1U));
+			profiler_name = _profiler_name;
+		}
+
+		void LuaController::StopProfiler()
+		{
+			if (profiler == nullptr)
+				return;
+
+			// Write profile
+			std::string profile_name = profiler_name.empty() ? Lua_ProfileName(name) : profiler_name;
+			profiler->WriteCollapsed(profile_name);
+			profiler->WriteChromeTrace(profile_name);
+			profiler.reset();
+		}
+
+		void LuaController::Interrupt(lua_State *state, int gc)
+		{
+			// Garbage collector interrupts don't belong to a script
+			if (gc >= 0)
+				return;
+
+			if (profiler != nullptr)
+				profiler->Interrupt(state);
+
+			// Check watchdog budgets
+			if (watchdog_depth == 0)
+				return;
+
+			// Once killed, error at every interrupt so pcall can't catch its way back into the script
+			if (watchdog_killed)
+				luaL_error(state, "script was stopped by the watchdog");
+
+			if ((++watchdog_tick % WATCHDOG_CHECK_INTERVAL) != 0)
+				return;
+
+			double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - watchdog_start).count();
+			const char *budget = nullptr;
+			if (watchdog_resume_us != 0.0 && elapsed_us > watchdog_resume_us)
+				budget = "resume";
+			else if (frame_driven && watchdog_frame_us != 0.0 && watchdog_frame_used_us + elapsed_us > watchdog_frame_us)
+				budget = "frame";
+			if (budget == nullptr)
+				return;
+			watchdog_killed = true;
+
+			// Error out of the script, naming where it was stuck
+			lua_Debug ar;
+			if (lua_getinfo(state, 0, "sl", &ar))
+				luaL_error(state, "script exceeded %s time budget in %s:%d", budget, ar.short_src, ar.currentline);
+			luaL_error(state, "script exceeded %s time budget", budget);
+		}
+
+		void LuaController::RunBegin()
+		{
+			if (watchdog_depth++ == 0)
+				watchdog_start = std::chrono::steady_clock::now();
+		}
+
+		void LuaController::RunEnd()
+		{
+			if (--watchdog_depth != 0)
+				return;
+			watchdog_frame_used_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - watchdog_start).count();
+
+			// Controllers sharing a template's state are capped by what their category holds once they stop running
+			if (parent != nullptr)
+			{
+				size_t used = MemoryUsed();
+				memory_peak = std::max(memory_peak, used);
+				if (memory_limit != 0 && used > memory_limit && !watchdog_killed)
+				{
+					watchdog_killed = true;
+					LogError("Lua controller exceeded its memory limit, its scripts were stopped");
+				}
+			}
+		}
+
+		void LuaController::PauseBegin()
+		{
+			if (watchdog_depth != 0 && watchdog_pause_depth++ == 0)
+				watchdog_pause_start = std::chrono::steady_clock::now();
+		}
+
+		void LuaController::PauseEnd()
+		{
+			// Move the run's start forward by the pause, so both budgets skip it
+			if (watchdog_depth != 0 && --watchdog_pause_depth == 0)
+				watchdog_start += std::chrono::steady_clock::now() - watchdog_pause_start;
+		}
+
+		WatchdogPause::WatchdogPause(lua_State *state) : controller(LuaController::Get(state))
+		{
+			if (controller != nullptr)
+				controller->PauseBegin();
+		}
+
+		WatchdogPause::~WatchdogPause()
+		{
+			if (controller != nullptr)
+				controller->PauseEnd();
+		}
+
+		WatchdogScope::WatchdogScope(lua_State *state) : controller(LuaController::Get(state))
+		{
+			if (controller != nullptr)
+				controller->RunBegin();
+		}
+
+		WatchdogScope::~WatchdogScope()
+		{
+			if (controller != nullptr)
+				controller->RunEnd();
+		}
+
+		void LuaController::StepFrame()
+		{
+			// Start new frame budget
+			watchdog_frame_used_us = 0.0;
+
+			// Resume threads whose frame has come
+			frame += 1.0;
+			while (!wait_frames.empty() && wait_frames.top().time <= frame)
+			{
+				int thread_ref = wait_frames.top().thread_ref;
+				wait_frames.pop();
+				Resume(thread_ref);
+			}
+		}
+
+		void LuaController::SetBeat(double _beat)
+		{
+			// Take threads whose beat has come before resuming any, threads that wait again wait for the next beat
+			beat = _beat;
+			std::vector<int> thread_refs;
+			while (!wait_beats.empty() && wait_beats.top().time <= beat)
+			{
+				thread_refs.push_back(wait_beats.top().thread_ref);
+				wait_beats.pop();
+			}
+			for (int thread_ref : thread_refs)
+				Resume(thread_ref);
+		}
+
+		void LuaController::Signal(uint64_t event)
+		{
+			// Resume threads waiting on event, threads that wait on it again wait for the next signal
+			auto waiting = wait_events.find(event);
+			if (waiting == wait_events.end())
+				return;
+
+			std::vector<int> thread_refs = std::move(waiting->second);
+			wait_events.erase(waiting);
+			for (int thread_ref : thread_refs)
+				Resume(thread_ref);
+		}
+
+		int LuaController::WaitFrames(lua_State *state, double frames)
+		{
+			wait_frames.push({ frame + std::max(frames, 1.0), wait_order++, Suspend(state) });
+			return lua_yield(state, 0);
+		}
+
+		int LuaController::WaitBeats(lua_State *state, double beats)
+		{
+			wait_beats.push({ beat + std::max(beats, 0.0), wait_order++, Suspend(state) });
+			return lua_yield(state, 0);
+		}
+
+		int LuaController::WaitEvent(lua_State *state, uint64_t event)
+		{
+			wait_events[event].push_back(Suspend(state));
+			return lua_yield(state, 0);
+		}
+
+		int LuaController::Suspend(lua_State *state)
+		{
+			// Module threads and coroutines are resumed by their caller, so only spawned threads can wait
+			lua_getref(state, spawned_ref);
+			lua_pushthread(state);
+			lua_rawget(state, -2);
+			bool spawned = lua_toboolean(state, -1) != 0;
+			lua_pop(state, 2);
+			if (!spawned || !lua_isyieldable(state))
+				luaL_error(state, "attempt to wait outside of a spawned thread");
+
+			// Hold thread until it's resumed
+			lua_pushthread(state);
+			int thread_ref = lua_ref(state, -1);
+			lua_pop(state, 1);
+			return thread_ref;
+		}
+
+		void LuaController::Resume(int thread_ref)
+		{
+			// Killed controllers don't run again, their waiting threads are just dropped
+			if (watchdog_killed)
+			{
+				lua_unref(global_state, thread_ref);
+				return;
+			}
+
+			// Get thread, keeping it on our stack while it runs
+			lua_getref(global_state, thread_ref);
+			lua_unref(global_state, thread_ref);
+			lua_State *thread = lua_tothread(global_state, -1);
+
+			// Threads that have finished since they waited are dropped
+			if (thread == nullptr || lua_status(thread) != LUA_YIELD)
+			{
+				lua_pop(global_state, 1);
+				return;
+			}
+
+			// Resume thread
+			int status;
+			{
+				WatchdogScope watchdog(thread);
+				status = lua_resume(thread, global_state, 0);
+			}
+			if (status != LUA_OK && status != LUA_YIELD)
+			{
+				// Log the error and kill the thread, one failing script thread shouldn't stop the frame
+				std::string error = lua_isstring(thread, -1) ? lua_tostring(thread, -1) : "unknown error";
+				lua_resetthread(thread);
+				lua_pop(global_state, 1);
+				LogError("Error resuming thread: " + error);
+				return;
+			}
+			lua_pop(global_state, 1);
 		}
 
 		void LuaController::Require(std::string name)
@@ -163,14 +973,21 @@ namespace PaperPup
 			// Our stack contains the module
 		}
 
-		void LuaController::RequireSource(std::string source, std::string name)
+		void LuaController::RequireSource(const char *source, size_t source_size, std::string name)
 		{
 			// Require module
-			Lua_RequireSource(global_state, source, name);
+			Lua_RequireSource(global_state, source, source_size, name);
 			// Our stack contains the module
 		}
 
-		void LuaController::Register(const char *name, luaL_Reg *library, luaL_Reg *meta)
+		bool LuaController::RequireBytecode(Filesystem::File *file, std::string name)
+		{
+			// Require module
+			return Lua_RequireBytecode(global_state, file->Data(), file->Size(), name);
+			// Our stack contains the module if successful
+		}
+
+		int LuaController::Register(const char *name, luaL_Reg *library, luaL_Reg *meta)
 		{
 			// Create metatable
 			luaL_newmetatable(global_state, name);
@@ -186,6 +1003,15 @@ namespace PaperPup
 				lua_settable(global_state, -3);
 			}
 
+			// Look up methods in the metatable unless it has its own __index
+			lua_getfield(global_state, -1, "__index");
+			if (lua_isnil(global_state, -1))
+			{
+				lua_pushvalue(global_state, -2);
+				lua_setfield(global_state, -3, "__index");
+			}
+			lua_pop(global_state, 1);
+
 			lua_setreadonly(global_state, -1, true);
 			lua_pop(global_state, 1);
 
@@ -196,6 +1022,9 @@ namespace PaperPup
 			lua_setreadonly(global_state, -1, true);
 
 			lua_pop(global_state, 2);
+
+			// Return userdata tag for class
+			return Lua_UserdataTag(name);
 		}
 	}
 }
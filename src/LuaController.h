@@ -15,11 +15,21 @@
 
 #include "Platform/Filesystem.h"
 
+#include "LuaAllocator.h"
+#include "LuaProfiler.h"
+#include "LuaCommands.h"
+
 #include <lua.h>
 #include <lualib.h>
 
 #include <string>
+#include <memory>
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <chrono>
 #include <iostream>
+#include <type_traits>
 
 namespace PaperPup
 {
@@ -67,9 +77,37 @@ namespace PaperPup
 			#endif
 		}
 
+		// Watchdog scope, times script run inside it against the budgets of the controller owning the thread
+		class LuaController;
+
+		class WatchdogScope
+		{
+			private:
+				LuaController *controller;
+
+			public:
+				WatchdogScope(lua_State *state);
+				~WatchdogScope();
+		};
+
+		// Watchdog pause, time spent inside it, such as compiling a required module, isn't counted
+		class WatchdogPause
+		{
+			private:
+				LuaController *controller;
+
+			public:
+				WatchdogPause(lua_State *state);
+				~WatchdogPause();
+		};
+
 		static void ProtectedCall(lua_State *state, int nargs, int nresults)
 		{
-			int call_result = lua_pcall(state, nargs, nresults, 0);
+			int call_result;
+			{
+				WatchdogScope watchdog(state);
+				call_result = lua_pcall(state, nargs, nresults, 0);
+			}
 			switch (call_result)
 			{
 				case LUA_OK:
@@ -91,9 +129,20 @@ namespace PaperPup
 			}
 		}
 
+		// Userdata tag and name of each registered class, tag is -1 if it has to be checked by metatable
+		template<typename T> struct UserdataTag
+		{
+			static inline int tag = -1;
+			static inline const char *name = nullptr;
+		};
+
 		template<typename T> static T *AllocUserdata(lua_State *state, const char *name)
 		{
-			T *userdata = (T*)lua_newuserdata(state, sizeof(T));
+			T *userdata;
+			if (UserdataTag<T>::tag >= 0)
+				userdata = (T*)lua_newuserdatatagged(state, sizeof(T), UserdataTag<T>::tag);
+			else
+				userdata = (T*)lua_newuserdata(state, sizeof(T));
 			luaL_getmetatable(state, name);
 			lua_setmetatable(state, -2);
 			return userdata;
@@ -101,6 +150,10 @@ namespace PaperPup
 
 		template<typename T> static bool IsUserdata(lua_State *state, int index, const char *name)
 		{
+			// Tagged classes only need their tag compared
+			if (UserdataTag<T>::tag >= 0)
+				return lua_userdatatag(state, index) == UserdataTag<T>::tag;
+
 			// Get userdata
 			T *p = (T *)lua_touserdata(state, index);
 			if (p == nullptr)
@@ -111,12 +164,11 @@ namespace PaperPup
 				return false;
 
 			lua_getfield(state, LUA_REGISTRYINDEX, name);
-			if (!lua_rawequal(state, -1, -2))
-				return false;
+			bool result = lua_rawequal(state, -1, -2);
 
 			// Pop userdata and metatable off stack
 			lua_pop(state, 2);
-			return true;
+			return result;
 		}
 
 		template<typename T> static T *GetUserdata(lua_State *state, int index, const char *name)
@@ -127,6 +179,14 @@ namespace PaperPup
 				// Return userdata
 				return (T*)lua_touserdata(state, index);
 			#else
+				// Tagged classes only need their tag compared
+				if (UserdataTag<T>::tag >= 0)
+				{
+					T *p = (T*)lua_touserdatatagged(state, index, UserdataTag<T>::tag);
+					assert(p != nullptr);
+					return p;
+				}
+
 				// Get userdata
 				T *p = (T*)lua_touserdata(state, index);
 				assert(p != nullptr);
@@ -162,37 +222,293 @@ namespace PaperPup
 			return result;
 		}
 
+		// Field handle, a field name string kept in the registry so it's only interned once
+		struct FieldHandle
+		{
+			int ref;
+			const char *name;
+		};
+
+		static void GetField(lua_State *state, int index, FieldHandle field)
+		{
+			index = lua_absindex(state, index);
+			lua_getref(state, field.ref);
+			lua_gettable(state, index);
+		}
+
+		static void ReadField(lua_State *state, int index, FieldHandle field, std::string &out)
+		{
+			GetField(state, index, field);
+			size_t length;
+			const char *str = lua_tolstring(state, -1, &length);
+			if (str == nullptr)
+				throw PaperPup::RuntimeError("Field " + std::string(field.name) + " is not a string");
+			out.assign(str, length);
+			lua_pop(state, 1);
+		}
+
+		static void ReadField(lua_State *state, int index, FieldHandle field, double &out)
+		{
+			GetField(state, index, field);
+			if (!lua_isnumber(state, -1))
+				throw PaperPup::RuntimeError("Field " + std::string(field.name) + " is not a number");
+			out = lua_tonumber(state, -1);
+			lua_pop(state, 1);
+		}
+
+		static void ReadField(lua_State *state, int index, FieldHandle field, int &out)
+		{
+			double value;
+			ReadField(state, index, field, value);
+			out = (int)value;
+		}
+
+		static void ReadField(lua_State *state, int index, FieldHandle field, bool &out)
+		{
+			GetField(state, index, field);
+			if (!lua_isboolean(state, -1))
+				throw PaperPup::RuntimeError("Field " + std::string(field.name) + " is not a boolean");
+			out = lua_toboolean(state, -1) != 0;
+			lua_pop(state, 1);
+		}
+
+		static std::string GetString(lua_State *state, int index, FieldHandle field)
+		{
+			std::string result;
+			ReadField(state, index, field, result);
+			return result;
+		}
+
+		// Struct reader, reads several typed fields of one table
+		template<typename T> struct FieldOut
+		{
+			FieldHandle field;
+			T *out;
+		};
+
+		template<typename T> static FieldOut<T> Out(FieldHandle field, T &out)
+		{
+			return { field, &out };
+		}
+
+		template<typename... T> static void ReadFields(lua_State *state, int index, FieldOut<T>... fields)
+		{
+			index = lua_absindex(state, index);
+			(ReadField(state, index, fields.field, *fields.out), ...);
+		}
+
 		// Lua controller class
+		struct GCStats
+		{
+			// Heap size after the last step
+			size_t heap_bytes = 0;
+
+			// Time spent collecting last frame, and the longest single collection
+			double step_us = 0.0;
+			double pause_max_us = 0.0;
+
+			// Step, finished cycle, and emergency full collection counts
+			unsigned long long steps = 0, cycles = 0, emergencies = 0;
+		};
+
 		class LuaController
 		{
+			private:
+				// State allocator, shared with controllers made from our template
+				std::unique_ptr<Allocator> allocator_owned;
+				Allocator *allocator;
+
+				// Field name handles, only kept by the template
+				std::unordered_map<std::string, int> field_refs;
+
+				// Template we're a thread of, and the references keeping our thread and modules alive
+				LuaController *parent = nullptr;
+				int thread_ref = LUA_NOREF;
+				int modules_ref = LUA_NOREF;
+
+				// Threads created by spawn, weakly keyed, only these may wait on the scheduler
+				int spawned_ref = LUA_NOREF;
+
+				// Memory category our allocations are counted under, controllers made from a template each get their own
+				int memcat = 0;
+				std::vector<int> memcats_free;
+				int memcat_next = 1;
+				size_t memory_limit = 0, memory_peak = 0;
+
+				// Frame driven garbage collection, only for controllers with their own state
+				bool frame_driven;
+				bool gc_cycle = false;
+				size_t gc_heap_base = 0;
+				GCStats gc_stats;
+
+				// Command buffer, created when first used
+				std::unique_ptr<CommandBuffer> commands;
+
+				// Controller name, naming its profile after the pack or script it runs
+				std::string name;
+
+				// Sampling profiler, only present while profiling
+				std::unique_ptr<Profiler> profiler;
+				std::string profiler_name;
+
+				// Scheduler, waiting threads are held by registry references
+				struct Waiting
+				{
+					double time;
+					uint64_t order;
+					int thread_ref;
+
+					bool operator>(const Waiting &other) const
+					{
+						if (time != other.time)
+							return time > other.time;
+						return order > other.order;
+					}
+				};
+				std::priority_queue<Waiting, std::vector<Waiting>, std::greater<Waiting>> wait_frames, wait_beats;
+				std::unordered_map<uint64_t, std::vector<int>> wait_events;
+				uint64_t wait_order = 0;
+
+				double frame = 0.0, beat = 0.0;
+				uint64_t event_next = 1;
+
+				// Watchdog, checked every few interrupts while script runs
+				double watchdog_resume_us = 0.0, watchdog_frame_us = 0.0;
+				unsigned int watchdog_depth = 0, watchdog_tick = 0, watchdog_pause_depth = 0;
+				std::chrono::steady_clock::time_point watchdog_start, watchdog_pause_start;
+				double watchdog_frame_used_us = 0.0;
+				bool watchdog_killed = false; // Set once a budget trips, the controller's scripts never run again
+
 			public:
 				// Lua objects
 				lua_State *global_state;
 
 			public:
 				// Lua controller interface
-				LuaController();
+				LuaController(bool _frame_driven = false);
+				LuaController(LuaController &_parent);
 				~LuaController();
 
+				// Template controller of the calling thread, controllers made from it start with its libraries and modules
+				// Threads release their template before the engine shuts down
+				static LuaController &Template();
+				static void ReleaseTemplate();
+
+				// Controller owning a Lua thread
+				static LuaController *Get(lua_State *state)
+				{
+					return (LuaController*)lua_getthreaddata(state);
+				}
+
+				void PushModules(lua_State *state)
+				{
+					lua_getref(state, modules_ref);
+				}
+
+				// Field handle for name, valid as long as our template
+				FieldHandle Field(const std::string &name);
+
+				// Garbage collection, only driven by the engine for frame driven controllers
+				void StepGC(double budget_us);
+				const GCStats &GetGCStats() const { return gc_stats; }
+
+				void SetName(std::string _name) { name = _name; }
+				const std::string &Name() const { return name; }
+
+				// Profiling, stopping writes the profile to Profiles/<name>.folded and Profiles/<name>.json
+				// Profiles started without a name are named after the controller when written
+				void StartProfiler(std::string _profiler_name, unsigned int interval_us);
+				void StopProfiler();
+
+				// Interrupt, called at Luau safepoints
+				void Interrupt(lua_State *state, int gc);
+
+				// Watchdog, nested runs count as part of the outermost run
+				void RunBegin();
+				void RunEnd();
+				void PauseBegin();
+				void PauseEnd();
+				bool Killed() const { return watchdog_killed; }
+
+				// Command buffer, dispatched by the engine each frame for frame driven controllers
+				CommandBuffer &Commands()
+				{
+					if (commands == nullptr)
+						commands = std::make_unique<CommandBuffer>(global_state);
+					return *commands;
+				}
+				void DispatchCommands()
+				{
+					if (commands != nullptr)
+						commands->Dispatch();
+				}
+
+				// Scheduler, resumes threads waiting for a frame, beat, or event
+				void StepFrame();
+				void SetBeat(double _beat);
+
+				uint64_t NewEvent() { return event_next++; }
+				void Signal(uint64_t event);
+
+				int WaitFrames(lua_State *state, double frames);
+				int WaitBeats(lua_State *state, double beats);
+				int WaitEvent(lua_State *state, uint64_t event);
+
 				void Require(std::string name);
-				void RequireSource(std::string source, std::string name);
+				void Preload(std::string name)
+				{
+					Require(name);
+					lua_pop(global_state, 1);
+				}
+				void RequireSource(const char *source, size_t source_size, std::string name);
+				void RequireSource(const std::string &source, std::string name)
+				{
+					RequireSource(source.data(), source.size(), name);
+				}
 				void RequireFile(Filesystem::File *file, std::string name)
 				{
 					if (file == nullptr)
 						throw PaperPup::RuntimeError("Failed to open source for module " + name);
-					RequireSource(std::string(file->Dup(), file->Size()), name);
+					RequireSource(file->Data(), file->Size(), name);
 				}
+				bool RequireBytecode(Filesystem::File *file, std::string name);
 				void RequireImageFile(Filesystem::Image *image, std::string name)
 				{
+					std::unique_ptr<Filesystem::File> bytecode(image->OpenBytecode(name));
+					if (bytecode != nullptr && RequireBytecode(bytecode.get(), name))
+						return;
+
 					std::unique_ptr<Filesystem::File> file(image->OpenFile(name, false));
-					if (file == nullptr)
-						throw PaperPup::RuntimeError("Failed to open source for module " + name);
+					RequireFile(file.get(), name);
+				}
+
+				size_t MemoryUsed() const { return (parent != nullptr) ? lua_totalbytes(global_state, memcat) : allocator->Used(); }
+				size_t MemoryPeak() const { return (parent != nullptr) ? memory_peak : allocator->Peak(); }
 
-					std::unique_ptr<char[]> source(file->Dup());
-					RequireSource(std::string(source.get(), file->Size()), name);
+				int Register(const char *name, luaL_Reg *library, luaL_Reg *meta);
+				template<typename T> void Register(const char *name, luaL_Reg *library, luaL_Reg *meta)
+				{
+					// Tags are shared by every controller, the first registration must happen on the main thread before any worker thread registers
+					int tag = Register(name, library, meta);
+					if (UserdataTag<T>::name == nullptr)
+					{
+						UserdataTag<T>::tag = tag;
+						UserdataTag<T>::name = name;
+					}
+
+					// Destruct tagged userdata when collected
+					if constexpr (!std::is_trivially_destructible_v<T>)
+					{
+						if (UserdataTag<T>::tag >= 0)
+							lua_setuserdatadtor(global_state, UserdataTag<T>::tag, [](lua_State *state, void *userdata) { (void)state; ((T*)userdata)->~T(); });
+					}
 				}
 
-				void Register(const char *name, luaL_Reg *library, luaL_Reg *meta);
+			private:
+				void Init();
+
+				int Suspend(lua_State *state);
+				void Resume(int thread_ref);
 		};
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,113 @@
+/*
+ * [PaperPup]
+ *   LuaFilesystem.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "LuaFilesystem.h"
+
+#include "LuaBind.h"
+
+#include "Engine.h"
+
+#include <new>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		// Lua filesystem library
+		void RegisterFilesystem(LuaController &lua)
+		{
+			// Register file class
+			static luaL_Reg lib_file[] = {
+				{nullptr, nullptr}
+			};
+			static luaL_Reg meta_file[] = {
+				Method<&LuaFile::Size>("size"),
+				Method<&LuaFile::ReadU8>("readu8"),
+				Method<&LuaFile::ReadI8>("readi8"),
+				Method<&LuaFile::ReadU16>("readu16"),
+				Method<&LuaFile::ReadI16>("readi16"),
+				Method<&LuaFile::ReadU32>("readu32"),
+				Method<&LuaFile::ReadI32>("readi32"),
+				Method<&LuaFile::ReadString>("readstring"),
+				{nullptr, nullptr}
+			};
+			lua.Register<LuaFile>("File", lib_file, meta_file);
+
+			// Register mem classes
+			static luaL_Reg lib_memview[] = {
+				{nullptr, nullptr}
+			};
+			static luaL_Reg meta_memview[] = {
+				Method<&LuaMemView::Valid>("valid"),
+				Method<&LuaMemView::Offset>("offset"),
+				Method<&LuaMemView::ReadU8>("readu8"),
+				Method<&LuaMemView::ReadU16>("readu16"),
+				Method<&LuaMemView::ReadI16>("readi16"),
+				Method<&LuaMemView::ReadU32>("readu32"),
+				Method<&LuaMemView::ReadI32>("readi32"),
+				Method<&LuaMemView::View>("view"),
+				Method<&LuaMemView::Pointer>("pointer"),
+				{nullptr, nullptr}
+			};
+			lua.Register<LuaMemView>("MemView", lib_memview, meta_memview);
+
+			static luaL_Reg lib_mem[] = {
+				{nullptr, nullptr}
+			};
+			static luaL_Reg meta_mem[] = {
+				Method<&LuaMem::Size>("size"),
+				Method<&LuaMem::Base>("base"),
+				Method<&LuaMem::View>("view"),
+				Method<&LuaMem::Pointer>("pointer"),
+				{nullptr, nullptr}
+			};
+			lua.Register<LuaMem>("Mem", lib_mem, meta_mem);
+
+			// Register filesystem library
+			static luaL_Reg lib_filesystem[] = {
+				{"open", [](lua_State *state)
+				{
+					// Open file through the engine, returning nil if it doesn't exist
+					std::unique_ptr<Filesystem::File> file(g_engine->OpenFile(luaL_checkstring(state, 1), luaL_optboolean(state, 2, false)));
+					if (file == nullptr)
+					{
+						lua_pushnil(state);
+						return 1;
+					}
+
+					// Allocate before releasing, so the file is still owned if allocation throws
+					void *userdata = AllocUserdata<LuaFile>(state, "File");
+					new (userdata) LuaFile(file.release());
+					return 1;
+				}},
+				{"openmem", [](lua_State *state)
+				{
+					// Open a MEM block from an archive, relocated against the address it was linked to load at
+					std::unique_ptr<Filesystem::Mem> mem(g_engine->OpenMem(luaL_checkstring(state, 1), luaL_checkstring(state, 2), Arg<uint32_t>::Get(state, 3)));
+					if (mem == nullptr)
+					{
+						lua_pushnil(state);
+						return 1;
+					}
+
+					void *userdata = AllocUserdata<LuaMem>(state, "Mem");
+					new (userdata) LuaMem(mem.release());
+					return 1;
+				}},
+				{nullptr, nullptr}
+			};
+			static luaL_Reg meta_filesystem[] = {
+				{nullptr, nullptr}
+			};
+			lua.Register("Filesystem", lib_filesystem, meta_filesystem);
+		}
+	}
+}
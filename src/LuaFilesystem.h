@@ -0,0 +1,111 @@
+/*
+ * [PaperPup]
+ *   LuaFilesystem.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "LuaController.h"
+
+#include <string_view>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		// Lua file class
+		// Reads go straight to the file's memory, only readstring copies, and only the bytes asked for
+		class LuaFile
+		{
+			private:
+				// Opened file
+				std::unique_ptr<Filesystem::File> file;
+
+			public:
+				// Lua file interface
+				LuaFile(Filesystem::File *_file) : file(_file) {}
+
+				unsigned int Size() const { return (unsigned int)file->Size(); }
+
+				unsigned int ReadU8(unsigned int offset) const { return (uint8_t)*Range(offset, 1); }
+				int ReadI8(unsigned int offset) const { return (int8_t)*Range(offset, 1); }
+				unsigned int ReadU16(unsigned int offset) const { return Filesystem::Read16(Range(offset, 2)); }
+				int ReadI16(unsigned int offset) const { return (int16_t)Filesystem::Read16(Range(offset, 2)); }
+				unsigned int ReadU32(unsigned int offset) const { return Filesystem::Read32(Range(offset, 4)); }
+				int ReadI32(unsigned int offset) const { return (int32_t)Filesystem::Read32(Range(offset, 4)); }
+
+				std::string_view ReadString(unsigned int offset, unsigned int length) const
+				{
+					return std::string_view(Range(offset, length), length);
+				}
+
+			private:
+				const char *Range(unsigned int offset, unsigned int length) const
+				{
+					if (offset > file->Size() || length > file->Size() - offset)
+						throw PaperPup::RuntimeError("File read out of range");
+					return file->Data() + offset;
+				}
+		};
+
+		// Lua mem classes
+		// Views share their blob, so a view stays readable after the mem it came from is collected
+		class LuaMemView
+		{
+			private:
+				// Viewed blob
+				std::shared_ptr<const Filesystem::Mem> mem;
+				Filesystem::MemView view;
+
+			public:
+				// Lua mem view interface
+				LuaMemView(std::shared_ptr<const Filesystem::Mem> _mem, Filesystem::MemView _view) : mem(std::move(_mem)), view(_view) {}
+
+				bool Valid() const { return static_cast<bool>(view); }
+				unsigned int Offset() const { return (unsigned int)Check().Offset(); }
+
+				unsigned int ReadU8(unsigned int at) const { return Check().Read8(at); }
+				unsigned int ReadU16(unsigned int at) const { return Check().Read16(at); }
+				int ReadI16(unsigned int at) const { return Check().ReadS16(at); }
+				unsigned int ReadU32(unsigned int at) const { return Check().Read32(at); }
+				int ReadI32(unsigned int at) const { return Check().ReadS32(at); }
+
+				LuaMemView View(unsigned int at) const { return LuaMemView(mem, Check().View(at)); }
+				LuaMemView Pointer(unsigned int at) const { return LuaMemView(mem, Check().Pointer(at)); } // Null pointers give an invalid view
+
+			private:
+				const Filesystem::MemView &Check() const
+				{
+					if (!view)
+						throw PaperPup::RuntimeError("Mem view is null");
+					return view;
+				}
+		};
+
+		class LuaMem
+		{
+			private:
+				// Opened blob
+				std::shared_ptr<const Filesystem::Mem> mem;
+
+			public:
+				// Lua mem interface
+				LuaMem(Filesystem::Mem *_mem) : mem(_mem) {}
+
+				unsigned int Size() const { return (unsigned int)mem->Size(); }
+				unsigned int Base() const { return mem->Base(); }
+
+				LuaMemView View(unsigned int offset) const { return LuaMemView(mem, mem->View(offset)); }
+				LuaMemView Pointer(unsigned int offset) const { return LuaMemView(mem, mem->Pointer(offset)); }
+		};
+
+		// Lua filesystem library
+		void RegisterFilesystem(LuaController &lua);
+	}
+}
@@ -0,0 +1,161 @@
+/*
+ * [PaperPup]
+ *   LuaProfiler.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "LuaProfiler.h"
+
+#include "Platform/Filesystem.h"
+
+#include <map>
+#include <cstdio>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		// Profiler interface
+		Profiler::Profiler(unsigned int interval_us) : samples(PROFILER_SAMPLES), start(std::chrono::steady_clock::now())
+		{
+			// Start timer thread
+			timer_run = true;
+			timer = std::thread([this, interval_us]()
+			{
+				while (timer_run)
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(interval_us));
+					sample_pending.store(true, std::memory_order_relaxed);
+				}
+			});
+		}
+
+		Profiler::~Profiler()
+		{
+			// Stop timer thread
+			timer_run = false;
+			if (timer.joinable())
+				timer.join();
+		}
+
+		void Profiler::Record(lua_State *state)
+		{
+			sample_pending.store(false, std::memory_order_relaxed);
+
+			// Record stack into ring
+			Sample &sample = samples[sample_count % samples.size()];
+			sample.time_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+			sample.depth = 0;
+
+			lua_Debug ar;
+			for (int level = 0; sample.depth < PROFILER_DEPTH && lua_getinfo(state, level, "sn", &ar); level++)
+				sample.frames[sample.depth++] = Intern(ar);
+
+			if (sample.depth != 0)
+				sample_count++;
+		}
+
+		uint32_t Profiler::Intern(const lua_Debug &ar)
+		{
+			// Key on string contents, addresses are reused by other functions once collected
+			// The key buffer is reused, so only new frames allocate
+			frame_key.clear();
+			if (ar.source != nullptr)
+				frame_key += ar.source;
+			frame_key += '\0';
+			if (ar.name != nullptr)
+				frame_key += ar.name;
+			frame_key += '\0';
+			frame_key += std::to_string(ar.linedefined);
+
+			auto frame = frame_map.find(frame_key);
+			if (frame != frame_map.end())
+				return frame->second;
+
+			// Name new frame
+			std::string name = (ar.name != nullptr) ? ar.name : "anonymous";
+			if (ar.linedefined >= 0)
+				name += " (" + std::string(ar.short_src) + ":" + std::to_string(ar.linedefined) + ")";
+			else
+				name += " (" + std::string(ar.short_src) + ")";
+
+			uint32_t id = (uint32_t)frame_names.size();
+			frame_names.push_back(name);
+			frame_map.emplace(frame_key, id);
+			return id;
+		}
+
+		void Profiler::WriteCollapsed(std::string name) const
+		{
+			// Count identical stacks, written root first for flamegraph tools
+			std::map<std::string, unsigned long long> stacks;
+			ForEachSample([&](const Sample &sample)
+			{
+				std::string stack;
+				for (unsigned int i = sample.depth; i-- > 0;)
+				{
+					stack += frame_names[sample.frames[i]];
+					if (i != 0)
+						stack += ';';
+				}
+				stacks[stack]++;
+			});
+
+			std::string out;
+			for (auto &stack : stacks)
+				out += stack.first + " " + std::to_string(stack.second) + "\n";
+			Filesystem::WriteLocal("Profiles/" + name + ".folded", std::vector<char>(out.begin(), out.end()));
+		}
+
+		void Profiler::WriteChromeTrace(std::string name) const
+		{
+			auto Escape = [](const std::string &str)
+			{
+				std::string result;
+				for (char c : str)
+				{
+					if (c == '"' || c == '\\')
+						result += '\\';
+					if ((unsigned char)c >= 0x20)
+						result += c;
+				}
+				return result;
+			};
+
+			// Build stack frame tree, each node being a frame under its parent node
+			std::map<std::pair<uint32_t, uint32_t>, uint32_t> nodes;
+			std::string stack_frames, trace_samples;
+
+			ForEachSample([&](const Sample &sample)
+			{
+				uint32_t parent = 0;
+				for (unsigned int i = sample.depth; i-- > 0;)
+				{
+					auto node = nodes.emplace(std::make_pair(parent, sample.frames[i]), (uint32_t)nodes.size() + 1);
+					if (node.second)
+					{
+						if (!stack_frames.empty())
+							stack_frames += ",";
+						stack_frames += "\"" + std::to_string(node.first->second) + "\":{\"category\":\"lua\",\"name\":\"" + Escape(frame_names[sample.frames[i]]) + "\"";
+						if (parent != 0)
+							stack_frames += ",\"parent\":\"" + std::to_string(parent) + "\"";
+						stack_frames += "}";
+					}
+					parent = node.first->second;
+				}
+
+				if (!trace_samples.empty())
+					trace_samples += ",";
+				trace_samples += "{\"cat\":\"lua\",\"name\":\"sample\",\"pid\":0,\"tid\":0,\"ts\":" + std::to_string(sample.time_us) + ",\"sf\":\"" + std::to_string(parent) + "\",\"weight\":1}";
+			});
+
+			std::string out = "{\"traceEvents\":[],\"stackFrames\":{" + stack_frames + "},\"samples\":[" + trace_samples + "]}\n";
+			Filesystem::WriteLocal("Profiles/" + name + ".json", std::vector<char>(out.begin(), out.end()));
+		}
+	}
+}
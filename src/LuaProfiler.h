@@ -0,0 +1,89 @@
+/*
+ * [PaperPup]
+ *   LuaProfiler.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "Platform/Platform.h"
+
+#include <lua.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+namespace PaperPup
+{
+	namespace Lua
+	{
+		// Profiler constants
+		static constexpr unsigned int PROFILER_DEPTH = 32;
+		static constexpr size_t PROFILER_SAMPLES = 0x10000;
+
+		// Sampling profiler
+		// A timer thread raises a flag, and the next interrupt on the Lua thread records the stack
+		class Profiler
+		{
+			private:
+				// Sample ring, frames are listed leaf first
+				struct Sample
+				{
+					uint64_t time_us;
+					unsigned int depth;
+					uint32_t frames[PROFILER_DEPTH];
+				};
+				std::vector<Sample> samples;
+				size_t sample_count = 0;
+
+				// Interned frames, keyed by their source, name, and line
+				std::unordered_map<std::string, uint32_t> frame_map;
+				std::vector<std::string> frame_names;
+				std::string frame_key;
+
+				// Timer thread
+				std::thread timer;
+				std::atomic<bool> timer_run{false};
+				std::atomic<bool> sample_pending{false};
+
+				std::chrono::steady_clock::time_point start;
+
+			public:
+				// Profiler interface
+				Profiler(unsigned int interval_us);
+				~Profiler();
+
+				// Called from the Lua thread's interrupt
+				void Interrupt(lua_State *state)
+				{
+					if (sample_pending.load(std::memory_order_relaxed))
+						Record(state);
+				}
+
+				// Exports, written under Profiles/
+				void WriteCollapsed(std::string name) const;
+				void WriteChromeTrace(std::string name) const;
+
+			private:
+				void Record(lua_State *state);
+				uint32_t Intern(const lua_Debug &ar);
+
+				template<typename F> void ForEachSample(F &&func) const
+				{
+					// Visit samples oldest first
+					size_t first = sample_count > samples.size() ? sample_count - samples.size() : 0;
+					for (size_t i = first; i < sample_count; i++)
+						func(samples[i % samples.size()]);
+				}
+		};
+	}
+}
@@ -11,7 +11,10 @@
 
 #include "Menu/Menu.h"
 
+#include "Stage/Stage.h"
+
 #include "Platform/Audio.h"
+#include "Platform/Input.h"
 #include "Platform/Common/ADPCM.h"
 
 namespace PaperPup
@@ -31,6 +34,15 @@ namespace PaperPup
 
 		State *Menu::Start()
 		{
+			// Start loading packs
+			try
+			{
+				pack_loader = std::make_unique<PackLoader>();
+			}
+			catch (PaperPup::RuntimeError &exception) { (void)exception; }
+
+			preview = std::make_unique<Preview>();
+
 			std::unique_ptr<char[]> wave;
 			size_t wave_size;
 
@@ -53,11 +65,99 @@ namespace PaperPup
 
 			while (!g_engine->StartFrame())
 			{
+				// Take packs that have finished loading, packs that failed to load aren't listed
+				if (pack_loader != nullptr)
+				{
+					PackResult result;
+					while (pack_loader->Poll(result))
+					{
+						if (result.pack != nullptr)
+							packs.push_back(std::move(result.pack));
+					}
+					if (pack_loader->Done())
+						pack_loader.reset();
+				}
+
+				// Move song cursor, then start its preview once its window is read
+				UpdateCursor();
+				preview->Update();
+
+				// Play the song under the cursor, handing its pack over to the stage
+				State *next = nullptr;
+				if (cursor_valid && Input::ButtonPressed(Input::Button::Confirm))
+				{
+					Pack *pack;
+					size_t index;
+					CursorSong(pack, index);
+					for (auto &pack_listed : packs)
+					{
+						if (pack_listed.get() == pack)
+						{
+							next = new Stage::Stage(std::move(pack_listed), index);
+							break;
+						}
+					}
+				}
+
 				// End frame
 				g_engine->EndFrame();
+
+				if (next != nullptr)
+					return next;
 			}
 
 			return nullptr;
 		}
+
+		size_t Menu::SongCount() const
+		{
+			size_t count = 0;
+			for (auto &pack : packs)
+				count += pack->pack_songs.size();
+			return count;
+		}
+
+		void Menu::CursorSong(Pack *&pack, size_t &index) const
+		{
+			// Find the pack holding the cursor's song
+			index = cursor;
+			for (auto &pack_listed : packs)
+			{
+				if (index < pack_listed->pack_songs.size())
+				{
+					pack = pack_listed.get();
+					return;
+				}
+				index -= pack_listed->pack_songs.size();
+			}
+			pack = nullptr;
+		}
+
+		void Menu::UpdateCursor()
+		{
+			size_t song_count = SongCount();
+			if (song_count == 0)
+				return;
+
+			// Start on the first song once one is listed
+			size_t cursor_last = cursor;
+			if (cursor_valid)
+			{
+				if (Input::ButtonPressed(Input::Button::Down))
+					cursor = (cursor + 1) % song_count;
+				else if (Input::ButtonPressed(Input::Button::Up))
+					cursor = (cursor + song_count - 1) % song_count;
+				if (cursor == cursor_last)
+					return;
+			}
+			cursor_valid = true;
+
+			// Preview the song under the cursor
+			Pack *pack;
+			size_t index;
+			CursorSong(pack, index);
+			if (pack != nullptr)
+				preview->Select(pack, index);
+		}
 	}
 }
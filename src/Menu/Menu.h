@@ -15,6 +15,11 @@
 
 #include "Engine.h"
 #include "Pack.h"
+#include "PackLoader.h"
+#include "Menu/Preview.h"
+
+#include <vector>
+#include <memory>
 
 namespace PaperPup
 {
@@ -24,7 +29,18 @@ namespace PaperPup
 		class Menu : public State
 		{
 			private:
-				
+				// Packs, streamed in by the loader as they finish
+				std::unique_ptr<PackLoader> pack_loader;
+				std::vector<std::unique_ptr<Pack>> packs;
+
+				// Song cursor, over every listed pack's songs in listing order
+				// Packs are only ever appended, so the cursor stays on its song as more packs load
+				size_t cursor = 0;
+				bool cursor_valid = false;
+
+				// Song preview, selected as the cursor moves over songs
+				std::unique_ptr<Preview> preview;
+
 			public:
 				// Menu state interface
 				Menu();
@@ -34,6 +50,12 @@ namespace PaperPup
 
 				Filesystem::Archive *OpenArchive(std::string name) override { return nullptr; }
 				Filesystem::File *OpenFile(std::string name, bool mode2) override { return nullptr; }
+				Filesystem::File *OpenBytecode(std::string name) override { return nullptr; }
+
+			private:
+				size_t SongCount() const;
+				void CursorSong(Pack *&pack, size_t &index) const;
+				void UpdateCursor();
 		};
 	}
 }
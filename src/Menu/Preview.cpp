@@ -0,0 +1,203 @@
+/*
+ * [PaperPup]
+ *   Preview.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "Menu/Preview.h"
+
+#include "Platform/Userdata.h"
+
+#include <algorithm>
+
+namespace PaperPup
+{
+	namespace Menu
+	{
+		// Preview interface
+		Preview::Preview()
+		{
+			// Get window length and cache size
+			int window_seconds = std::max(Userdata::GetInteger("menu/preview_seconds", 15), 1);
+			window_size = ADPCM::SPU::SamplesToBlocks((size_t)window_seconds * PREVIEW_SAMPLE_RATE) * sizeof(ADPCM::SPU::Block);
+			cache_max = (size_t)std::max(Userdata::GetInteger("menu/preview_cache", 8), 0);
+		}
+
+		Preview::~Preview()
+		{
+			// Stop playing
+			Stop();
+
+			// Stop reader thread, if anything was ever selected
+			if (!thread.joinable())
+				return;
+			{
+				std::lock_guard<std::mutex> lock(request_mutex);
+				thread_run = false;
+			}
+			request_cv.notify_one();
+			thread.join();
+		}
+
+		void Preview::Select(Pack *pack, size_t index)
+		{
+			// Stop current preview and abandon its read
+			Stop();
+			uint64_t select_generation = ++generation;
+
+			const Song &song = pack->pack_songs.at(index);
+			if (song.song_preview.empty())
+				return;
+
+			// Get window position, aligned to SPU blocks
+			std::string path = song.song_path + "/" + song.song_preview;
+			size_t offset = ADPCM::SPU::SamplesToBlocks((size_t)song.song_preview_ms * PREVIEW_SAMPLE_RATE / 1000) * sizeof(ADPCM::SPU::Block);
+			std::string key = pack->pack_path + "/" + path + ":" + std::to_string(offset);
+
+			// Play cached window
+			for (auto it = cache.begin(); it != cache.end(); ++it)
+			{
+				if (it->key == key)
+				{
+					cache.splice(cache.begin(), cache, it);
+					Play(*it);
+					return;
+				}
+			}
+
+			// Request window, replacing any request the reader hasn't started
+			{
+				std::lock_guard<std::mutex> lock(request_mutex);
+				request.generation = select_generation;
+				request.image_name = "Packs/" + pack->pack_path + "/Image";
+				request.path = path;
+				request.key = key;
+				request.offset = offset;
+				request_pending = true;
+			}
+			request_cv.notify_one();
+
+			// Start reader thread on the first read
+			if (!thread.joinable())
+				thread = std::thread(&Preview::Read, this);
+		}
+
+		void Preview::Stop()
+		{
+			// Stop sound before its blocks
+			if (sound != nullptr)
+				sound->Stop();
+			sound.reset();
+			sound_window = Window();
+		}
+
+		void Preview::Update()
+		{
+			// Take window read for the current selection
+			Window window;
+			{
+				std::lock_guard<std::mutex> lock(result_mutex);
+				if (result.blocks == nullptr)
+					return;
+				if (result_generation == generation)
+					window = std::move(result);
+				result = Window();
+			}
+			if (window.blocks == nullptr)
+				return;
+
+			// Cache window
+			if (cache_max != 0)
+			{
+				cache.push_front(window);
+				if (cache.size() > cache_max)
+					cache.pop_back();
+			}
+
+			// Play window
+			Play(window);
+		}
+
+		void Preview::Play(const Window &window)
+		{
+			// Loop the window until the selection changes
+			Stop();
+			sound_window = window;
+			sound.reset(Audio::Sound<ADPCM::SPU::Channel>::New(sound_window.blocks.get(), sound_window.blocks_count, 0, 0));
+
+			{
+				Audio::SoundPtr<ADPCM::SPU::Channel> channel = sound->Source();
+				channel->SetSampleRate(0x1000 * PREVIEW_SAMPLE_RATE / ADPCM::SAMPLE_RATE);
+				channel->SetVolume(0x3FFF, 0x3FFF);
+			}
+			sound->Play();
+		}
+
+		void Preview::Read()
+		{
+			// Keep the last image open, previews mostly move within a pack
+			std::string image_name;
+			std::unique_ptr<Filesystem::Image> image;
+
+			while (1)
+			{
+				// Wait for request
+				Request read;
+				{
+					std::unique_lock<std::mutex> lock(request_mutex);
+					request_cv.wait(lock, [this]() { return request_pending || !thread_run; });
+					if (!thread_run)
+						break;
+					read = request;
+					request_pending = false;
+				}
+
+				try
+				{
+					// Open image
+					if (image == nullptr || image_name != read.image_name)
+					{
+						image.reset();
+						image.reset(Filesystem::Image::Open(read.image_name));
+						image_name = read.image_name;
+					}
+
+					// Read window in chunks, giving up as soon as the selection moves on
+					std::vector<char> data;
+					while (data.size() < window_size && generation == read.generation)
+					{
+						size_t chunk_size = std::min<size_t>(PREVIEW_CHUNK_SIZE, window_size - data.size());
+						std::unique_ptr<Filesystem::File> chunk(image->OpenFileRange(read.path, read.offset + data.size(), chunk_size));
+						if (chunk == nullptr || chunk->Size() == 0)
+							break;
+						data.insert(data.end(), chunk->Data(), chunk->Data() + chunk->Size());
+						if (chunk->Size() < chunk_size)
+							break;
+					}
+					if (generation != read.generation || data.size() < sizeof(ADPCM::SPU::Block))
+						continue;
+
+					// Copy into blocks, clearing flags so the window loops as a whole
+					size_t blocks_count = data.size() / sizeof(ADPCM::SPU::Block);
+					std::shared_ptr<ADPCM::SPU::Block[]> blocks(new ADPCM::SPU::Block[blocks_count]);
+					std::memcpy(blocks.get(), data.data(), blocks_count * sizeof(ADPCM::SPU::Block));
+					for (size_t i = 0; i < blocks_count; i++)
+						blocks[i][1] = 0;
+
+					// Hand window to the menu
+					std::lock_guard<std::mutex> lock(result_mutex);
+					result.key = read.key;
+					result.blocks = std::move(blocks);
+					result.blocks_count = blocks_count;
+					result_generation = read.generation;
+				}
+				catch (std::exception &exception) { (void)exception; }
+			}
+		}
+	}
+}
@@ -0,0 +1,105 @@
+/*
+ * [PaperPup]
+ *   Preview.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "PaperPup.h"
+
+#include "Pack.h"
+
+#include "Platform/Filesystem.h"
+#include "Platform/Audio.h"
+#include "Platform/Common/ADPCM.h"
+
+#include <string>
+#include <list>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace PaperPup
+{
+	namespace Menu
+	{
+		// Preview constants
+		static constexpr unsigned int PREVIEW_SAMPLE_RATE = 37800;
+		static constexpr size_t PREVIEW_CHUNK_SIZE = 0x10000; // Reads are cancelled between chunks
+
+		// Song preview class
+		// Streams a window of a song's preview audio from its pack image
+		// Only the latest selection is ever read, so scrolling can't queue up reads
+		class Preview
+		{
+			private:
+				// Preview window, SPU blocks
+				struct Window
+				{
+					std::string key;
+					std::shared_ptr<ADPCM::SPU::Block[]> blocks;
+					size_t blocks_count = 0;
+				};
+
+				// Recently previewed windows, most recent first
+				std::list<Window> cache;
+				size_t cache_max;
+
+				// Window length in bytes
+				size_t window_size;
+
+				// Requested window, replaced rather than queued
+				struct Request
+				{
+					uint64_t generation = 0;
+					std::string image_name, path, key;
+					size_t offset = 0;
+				};
+
+				std::mutex request_mutex;
+				std::condition_variable request_cv;
+				Request request;
+				bool request_pending = false;
+
+				// Current selection, reads for older generations are abandoned
+				std::atomic<uint64_t> generation{0};
+
+				// Finished window
+				std::mutex result_mutex;
+				Window result;
+				uint64_t result_generation = 0;
+
+				// Reader thread, started by the first read
+				std::thread thread;
+				bool thread_run = true;
+
+				// Playing preview
+				Window sound_window;
+				std::unique_ptr<Audio::Sound<ADPCM::SPU::Channel>> sound;
+
+			public:
+				// Preview interface
+				Preview();
+				~Preview();
+
+				// Selects the song to preview, stopping the current preview
+				void Select(Pack *pack, size_t index);
+				void Stop();
+
+				// Starts the preview once its window is read, call once per frame
+				void Update();
+
+			private:
+				void Play(const Window &window);
+				void Read();
+		};
+	}
+}
@@ -14,47 +14,80 @@
 namespace PaperPup
 {
 	// Pack interface
-	Pack::Pack(std::string name)
+	Pack::Pack(std::string name) : pack_path(name)
 	{
-		Lua::LuaController lua;
+		Lua::LuaController lua(Lua::LuaController::Template());
+		lua.SetName(name + "/PACK.LUA");
+		size_t memory_base = lua.MemoryUsed();
 
 		// Open pack image
-		std::unique_ptr<Filesystem::Image> pack_image(Filesystem::Image::Open("Packs/" + name + "/Image"));
-		if (pack_image == nullptr)
+		std::unique_ptr<Filesystem::Image> index_image(Filesystem::Image::Open("Packs/" + name + "/Image"));
+		if (index_image == nullptr)
 			throw PaperPup::RuntimeError(name + " pack has no image");
 
 		// Open pack module
-		lua.RequireImageFile(pack_image.get(), "PACK.LUA");
+		lua.RequireImageFile(index_image.get(), "PACK.LUA");
+
+		// Get field handles
+		Lua::FieldHandle field_name = lua.Field("Name");
+		Lua::FieldHandle field_description = lua.Field("Description");
+		Lua::FieldHandle field_version = lua.Field("Version");
+		Lua::FieldHandle field_songs = lua.Field("Songs");
+		Lua::FieldHandle field_path = lua.Field("Path");
+		Lua::FieldHandle field_preview = lua.Field("Preview");
+		Lua::FieldHandle field_preview_start = lua.Field("PreviewStart");
 
 		// Get pack information
-		pack_name = Lua::GetString(lua.global_state, -1, "Name");
-		pack_description = Lua::GetString(lua.global_state, -1, "Description");
-		pack_version = Lua::GetString(lua.global_state, -1, "Version");
+		Lua::ReadFields(lua.global_state, -1, Lua::Out(field_name, pack_name), Lua::Out(field_description, pack_description), Lua::Out(field_version, pack_version));
 
 		// Get pack songs table
-		lua_getfield(lua.global_state, -1, "Songs");
+		Lua::GetField(lua.global_state, -1, field_songs);
 		if (!lua_istable(lua.global_state, -1))
 			throw PaperPup::RuntimeError("Field Songs is not a table");
 
 		lua_pushnil(lua.global_state);
 		while (lua_next(lua.global_state, -2))
 		{
-			// Get song name
-			std::string song_name = lua_tostring(lua.global_state, -1);
-
-			// Open song module
-			lua.RequireImageFile(pack_image.get(), song_name + "/SONG.LUA");
-
-			// Get song information
+			// Get song index entry, either the song's folder or a table naming it
+			// Song modules aren't run here, so listing a pack costs only PACK.LUA
 			Song song;
-			song.song_name = Lua::GetString(lua.global_state, -1, "Name");
-			song.song_description = Lua::GetString(lua.global_state, -1, "Description");
-			pack_songs.push_back(song);
+			if (lua_istable(lua.global_state, -1))
+			{
+				Lua::ReadFields(lua.global_state, -1, Lua::Out(field_path, song.song_path));
+				song.song_name = song.song_path;
+				Lua::GetField(lua.global_state, -1, field_name);
+				if (lua_type(lua.global_state, -1) == LUA_TSTRING)
+					song.song_name = lua_tostring(lua.global_state, -1);
+				lua_pop(lua.global_state, 1);
+				Lua::GetField(lua.global_state, -1, field_description);
+				if (lua_type(lua.global_state, -1) == LUA_TSTRING)
+					song.song_description = lua_tostring(lua.global_state, -1);
+				lua_pop(lua.global_state, 1);
+				Lua::GetField(lua.global_state, -1, field_preview);
+				if (lua_type(lua.global_state, -1) == LUA_TSTRING)
+					song.song_preview = lua_tostring(lua.global_state, -1);
+				lua_pop(lua.global_state, 1);
+				Lua::GetField(lua.global_state, -1, field_preview_start);
+				if (lua_isnumber(lua.global_state, -1))
+				{
+					// Clamp before converting, NaN and out of range times can't be cast
+					double preview_ms = lua_tonumber(lua.global_state, -1) * 1000.0;
+					if (!(preview_ms > 0.0))
+						preview_ms = 0.0;
+					song.song_preview_ms = (uint32_t)std::min(preview_ms, (double)UINT32_MAX);
+				}
+				lua_pop(lua.global_state, 1);
+			}
+			else
+			{
+				const char *song_path = lua_tostring(lua.global_state, -1);
+				if (song_path == nullptr)
+					throw PaperPup::RuntimeError("Song entry is not a string or table");
+				song.song_path = song.song_name = song_path;
+			}
+			pack_songs.push_back(std::move(song));
 
-			// Pop song module
-			lua_pop(lua.global_state, 1);
-
-			// Pop song name
+			// Pop song entry
 			lua_pop(lua.global_state, 1);
 		}
 
@@ -63,10 +96,240 @@ namespace PaperPup
 
 		// Pop pack module
 		lua_pop(lua.global_state, 1);
+
+		// Record memory usage, our heap is shared with the template so only count what we added
+		pack_memory = lua.MemoryUsed() - std::min(memory_base, lua.MemoryUsed());
+	}
+
+	Pack::Pack(std::string name, const char *data, size_t size) : pack_path(name)
+	{
+		/*
+			Pack Metadata Structure (strings are a length followed by their bytes):
+			  Name
+			  Description
+			  Version
+			  Song count
+			  Songs (path, name, description, preview path, preview start in milliseconds)
+		*/
+		const char *datap = data;
+		const char *data_end = data + size;
+
+		pack_name = Pack_ReadString(datap, data_end);
+		pack_description = Pack_ReadString(datap, data_end);
+		pack_version = Pack_ReadString(datap, data_end);
+
+		uint32_t song_count = Pack_Read32(datap, data_end);
+		for (uint32_t i = 0; i < song_count; i++)
+		{
+			Song song;
+			song.song_path = Pack_ReadString(datap, data_end);
+			song.song_name = Pack_ReadString(datap, data_end);
+			song.song_description = Pack_ReadString(datap, data_end);
+			song.song_preview = Pack_ReadString(datap, data_end);
+			song.song_preview_ms = Pack_Read32(datap, data_end);
+			pack_songs.push_back(std::move(song));
+		}
 	}
 
 	Pack::~Pack()
 	{
+		// Unload songs before their image
+		for (size_t i = 0; i < pack_songs.size(); i++)
+			UnloadSong(i);
+	}
+
+	std::vector<char> Pack::Metadata() const
+	{
+		std::vector<char> metadata;
+		Pack_WriteString(metadata, pack_name);
+		Pack_WriteString(metadata, pack_description);
+		Pack_WriteString(metadata, pack_version);
+
+		Pack_Write32(metadata, (uint32_t)pack_songs.size());
+		for (auto &song : pack_songs)
+		{
+			Pack_WriteString(metadata, song.song_path);
+			Pack_WriteString(metadata, song.song_name);
+			Pack_WriteString(metadata, song.song_description);
+			Pack_WriteString(metadata, song.song_preview);
+			Pack_Write32(metadata, song.song_preview_ms);
+		}
+		return metadata;
+	}
+
+	// Song interface
+	Song &Pack::LoadSong(size_t index)
+	{
+		Song &song = pack_songs.at(index);
+		if (song.Loaded())
+			return song;
+
+		// Open song module
+		std::unique_ptr<Lua::LuaController> lua = std::make_unique<Lua::LuaController>(Lua::LuaController::Template());
+		lua->SetName(pack_path + "/" + song.song_path + "/SONG.LUA");
+		size_t memory_base = lua->MemoryUsed();
+
+		lua->RequireImageFile(Image(), song.song_path + "/SONG.LUA");
+
+		// Get song information
+		Lua::FieldHandle field_name = lua->Field("Name");
+		Lua::FieldHandle field_description = lua->Field("Description");
+		Lua::ReadFields(lua->global_state, -1, Lua::Out(field_name, song.song_name), Lua::Out(field_description, song.song_description));
+
+		// Keep song module
+		song.song_module = lua_ref(lua->global_state, -1);
+		lua_pop(lua->global_state, 1);
+
+		song.song_memory = lua->MemoryUsed() - std::min(memory_base, lua->MemoryUsed());
+		song.song_lua = std::move(lua);
+		return song;
+	}
+
+	void Pack::UnloadSong(size_t index)
+	{
+		Song &song = pack_songs.at(index);
+		if (!song.Loaded())
+			return;
 
+		// Stop loading song assets
+		song.song_assets.reset();
+
+		// Release song module
+		lua_unref(song.song_lua->global_state, song.song_module);
+		song.song_module = LUA_NOREF;
+		song.song_lua.reset();
+		song.song_memory = 0;
+	}
+
+	void Pack::PushSong(size_t index)
+	{
+		// Push song module, loading it if needed
+		Song &song = LoadSong(index);
+		lua_getref(song.song_lua->global_state, song.song_module);
+	}
+
+	AssetLoader *Pack::PreloadSong(size_t index)
+	{
+		// Start asset loader
+		Song &song = LoadSong(index);
+		if (song.song_assets == nullptr)
+			song.song_assets = std::make_unique<AssetLoader>("Packs/" + pack_path + "/Image", SongManifest(index));
+		return song.song_assets.get();
+	}
+
+	std::vector<AssetRequest> Pack::SongManifest(size_t index)
+	{
+		/*
+			Song Assets Structure:
+			  Assets = {
+			    "CHART.BIN", -- Paths are relative to the song's folder
+			    { Path = "STAGE.TIM", Type = "Texture" },
+			    { Path = "VOICE.XA", Mode2 = true },
+			  }
+			  Track = 2 -- CD-DA track the song plays to, opened with the assets
+			Types are Data, Texture (TIM), or Sound (SPU blocks), untyped .TIM and .VB files are inferred
+		*/
+		PushSong(index);
+		Song &song = pack_songs[index];
+		lua_State *state = song.song_lua->global_state;
+
+		// Get field handles
+		Lua::FieldHandle field_assets = song.song_lua->Field("Assets");
+		Lua::FieldHandle field_path = song.song_lua->Field("Path");
+		Lua::FieldHandle field_type = song.song_lua->Field("Type");
+		Lua::FieldHandle field_mode2 = song.song_lua->Field("Mode2");
+		Lua::FieldHandle field_track = song.song_lua->Field("Track");
+
+		// Get assets table, songs without one only have their track to open
+		std::vector<AssetRequest> requests;
+		int top = lua_gettop(state) - 1;
+		Lua::GetField(state, -1, field_assets);
+
+		try
+		{
+			int assets_length = lua_istable(state, -1) ? lua_objlen(state, -1) : 0;
+			for (int i = 1; i <= assets_length; i++)
+			{
+				// Get asset entry
+				lua_rawgeti(state, -1, i);
+
+				AssetRequest request;
+				std::string type;
+				if (lua_istable(state, -1))
+				{
+					Lua::ReadFields(state, -1, Lua::Out(field_path, request.path));
+					Lua::GetField(state, -1, field_type);
+					if (lua_type(state, -1) == LUA_TSTRING)
+						type = lua_tostring(state, -1);
+					lua_pop(state, 1);
+					Lua::GetField(state, -1, field_mode2);
+					request.mode2 = lua_toboolean(state, -1) != 0;
+					lua_pop(state, 1);
+				}
+				else
+				{
+					const char *path = lua_tostring(state, -1);
+					if (path == nullptr)
+						throw PaperPup::RuntimeError("Asset entry is not a string or table");
+					request.path = path;
+				}
+
+				// Get asset type, inferring it from the extension if unspecified
+				if (type.empty())
+				{
+					size_t extension = request.path.find_last_of('.');
+					if (extension != std::string::npos)
+						type = request.path.substr(extension + 1);
+				}
+				if (type == "Texture" || type == "TIM")
+					request.type = AssetType::Texture;
+				else if (type == "Sound" || type == "VB")
+					request.type = AssetType::Sound;
+
+				request.path = song.song_path + "/" + request.path;
+				requests.push_back(std::move(request));
+
+				// Pop asset entry
+				lua_pop(state, 1);
+			}
+
+			// Open the song's audio track alongside its assets, after them so Assets positions index the manifest
+			Lua::GetField(state, -2, field_track);
+			if (lua_isnumber(state, -1))
+			{
+				double track = lua_tonumber(state, -1);
+				if (!(track >= 1.0 && track <= 99.0))
+					throw PaperPup::RuntimeError(song.song_path + " Track is not a track number");
+
+				AssetRequest request;
+				request.type = AssetType::Track;
+				request.track = (unsigned int)track;
+				request.path = "Track " + std::to_string(request.track);
+				requests.push_back(std::move(request));
+			}
+			lua_pop(state, 1);
+		}
+		catch (...)
+		{
+			// Leave the song's stack as we found it
+			lua_settop(state, top);
+			throw;
+		}
+
+		// Pop assets table and song module
+		lua_pop(state, 2);
+		return requests;
+	}
+
+	Filesystem::Image *Pack::Image()
+	{
+		// Open pack image
+		if (pack_image == nullptr)
+		{
+			pack_image.reset(Filesystem::Image::Open("Packs/" + pack_path + "/Image"));
+			if (pack_image == nullptr)
+				throw PaperPup::RuntimeError(pack_path + " pack has no image");
+		}
+		return pack_image.get();
 	}
 }
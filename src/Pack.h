@@ -16,26 +16,98 @@
 #include "Platform/Filesystem.h"
 
 #include "LuaController.h"
+#include "AssetLoader.h"
 
 namespace PaperPup
 {
+	// Pack metadata helpers
+	static inline void Pack_Write32(std::vector<char> &out, uint32_t value)
+	{
+		out.push_back(value >> 0); out.push_back(value >> 8); out.push_back(value >> 16); out.push_back(value >> 24);
+	}
+
+	static inline void Pack_WriteString(std::vector<char> &out, const std::string &value)
+	{
+		Pack_Write32(out, (uint32_t)value.size());
+		out.insert(out.end(), value.begin(), value.end());
+	}
+
+	static inline uint32_t Pack_Read32(const char *&datap, const char *data_end)
+	{
+		if ((data_end - datap) < 4)
+			throw PaperPup::RuntimeError("Pack metadata out of range");
+		uint32_t value = Filesystem::Read32(datap);
+		datap += 4;
+		return value;
+	}
+
+	static inline std::string Pack_ReadString(const char *&datap, const char *data_end)
+	{
+		uint32_t length = Pack_Read32(datap, data_end);
+		if ((size_t)(data_end - datap) < length)
+			throw PaperPup::RuntimeError("Pack metadata out of range");
+		std::string value(datap, length);
+		datap += length;
+		return value;
+	}
+
 	// Pack class
 	struct Song
 	{
-		// Song information
+		// Song information, from the pack index until the song is loaded
+		std::string song_path;
 		std::string song_name, song_description;
+
+		// Preview audio (SPU blocks) in the song's folder, and where in it the preview starts
+		std::string song_preview;
+		uint32_t song_preview_ms = 0;
+
+		// Song module, only run once the song is selected or previewed
+		std::unique_ptr<Lua::LuaController> song_lua;
+		int song_module = LUA_NOREF;
+
+		// Lua memory added loading the song
+		size_t song_memory = 0;
+
+		// Song assets, from the song module's Assets manifest
+		std::unique_ptr<AssetLoader> song_assets;
+
+		bool Loaded() const { return song_lua != nullptr; }
 	};
 
 	class Pack
 	{
 		public:
 			// Pack information
+			std::string pack_path;
 			std::string pack_name, pack_description, pack_version;
 			std::vector<Song> pack_songs;
+
+			// Lua memory added loading the pack
+			size_t pack_memory = 0;
+
+		private:
+			// Pack image, opened once a song is loaded
+			std::unique_ptr<Filesystem::Image> pack_image;
 			
 		public:
 			// Pack interface
 			Pack(std::string name);
+			Pack(std::string name, const char *data, size_t size);
 			~Pack();
+
+			// Metadata, everything the pack list needs without running the pack's scripts
+			std::vector<char> Metadata() const;
+
+			// Song interface
+			Song &LoadSong(size_t index);
+			void UnloadSong(size_t index);
+			void PushSong(size_t index);
+
+			// Starts loading a song's assets in the background, poll its loader's Upload each frame
+			AssetLoader *PreloadSong(size_t index);
+			std::vector<AssetRequest> SongManifest(size_t index);
+
+			Filesystem::Image *Image();
 	};
 }
@@ -0,0 +1,357 @@
+/*
+ * [PaperPup]
+ *   PackLoader.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "PackLoader.h"
+
+#include "LuaController.h"
+
+#include "Platform/Userdata.h"
+
+#include <algorithm>
+
+namespace PaperPup
+{
+	// Pack loader interface
+	PackLoader::PackLoader()
+	{
+		// Read pack index, or list the packs folder and read the metadata cache
+		if (!(index_valid = ReadIndex()))
+		{
+			names = Filesystem::GetPackList();
+			ReadCache();
+		}
+
+		// Register userdata tags on this thread, workers only read them
+		Lua::LuaController::Template();
+
+		// Start worker threads, menu/pack_threads of 0 uses every hardware thread
+		int threads = Userdata::GetInteger("menu/pack_threads", 0);
+		if (threads <= 0)
+			threads = (int)std::max(std::thread::hardware_concurrency(), 1U);
+		threads = std::min(threads, (int)names.size());
+
+		for (int i = 0; i < threads; i++)
+			workers.emplace_back(&PackLoader::Work, this);
+	}
+
+	PackLoader::~PackLoader()
+	{
+		// Stop worker threads after their current pack
+		workers_run = false;
+		for (auto &worker : workers)
+			worker.join();
+
+		// Write metadata cache, and the pack index once every pack has loaded
+		// A failed pack would be left out of the index and never probed again, so keep listing the folder until it loads
+		bool index_dirty = cache_dirty || !index_valid;
+		WriteCache();
+		if (index_dirty && results_done == names.size() && !results_failed)
+			WriteIndex();
+	}
+
+	bool PackLoader::Poll(PackResult &result)
+	{
+		std::lock_guard<std::mutex> lock(results_mutex);
+		if (results.empty())
+			return false;
+
+		result = std::move(results.front());
+		results.pop_front();
+		results_taken++;
+		return true;
+	}
+
+	void PackLoader::Work()
+	{
+		while (workers_run)
+		{
+			// Take next pack
+			size_t index = names_next++;
+			if (index >= names.size())
+				break;
+
+			// Load pack
+			PackResult result;
+			result.name = names[index];
+			try
+			{
+				result.pack.reset(Load(result.name));
+			}
+			catch (std::exception &exception)
+			{
+				result.error = exception.what();
+			}
+
+			if (result.pack == nullptr)
+			{
+				// Don't keep metadata of packs that no longer load
+				std::lock_guard<std::mutex> lock(cache_mutex);
+				cache_dirty |= cache_out.erase(result.name) != 0;
+				results_failed = true;
+			}
+
+			// Hand pack to the menu
+			std::lock_guard<std::mutex> lock(results_mutex);
+			results.push_back(std::move(result));
+			results_done++;
+		}
+
+		// Release this worker's Lua template before the thread ends
+		Lua::LuaController::ReleaseTemplate();
+	}
+
+	Pack *PackLoader::Load(const std::string &name)
+	{
+		// Trust indexed metadata if the image's files still stat the same
+		// Replacing an image doesn't always touch the packs folder's time, so the index alone isn't enough
+		std::string image_name = "Packs/" + name + "/Image";
+		uint64_t stat = Filesystem::ImageStat(image_name);
+		auto entry = cache.find(name);
+		if (index_valid && entry != cache.end() && entry->second.stat == stat)
+		{
+			try
+			{
+				return new Pack(name, entry->second.metadata.data(), entry->second.metadata.size());
+			}
+			catch (PaperPup::RuntimeError &exception) { (void)exception; }
+		}
+
+		// Use cached metadata if the pack's image hasn't changed
+		uint64_t size;
+		uint64_t stamp = Filesystem::ImageStamp(image_name, &size);
+		if (entry != cache.end() && entry->second.stamp == stamp && entry->second.size == size)
+		{
+			try
+			{
+				Pack *pack = new Pack(name, entry->second.metadata.data(), entry->second.metadata.size());
+				if (entry->second.stat != stat)
+				{
+					// Times can change without the contents, keep the new stat so the index trusts it again
+					std::lock_guard<std::mutex> lock(cache_mutex);
+					cache_out[name].stat = stat;
+					cache_dirty = true;
+				}
+				return pack;
+			}
+			catch (PaperPup::RuntimeError &exception) { (void)exception; }
+		}
+
+		// Load pack and cache its metadata
+		std::unique_ptr<Pack> pack = std::make_unique<Pack>(name);
+
+		std::lock_guard<std::mutex> lock(cache_mutex);
+		cache_out[name] = { stamp, size, stat, pack->Metadata() };
+		cache_dirty = true;
+		return pack.release();
+	}
+
+	void PackLoader::ReadCache()
+	{
+		/*
+			Pack Cache Structure:
+			   0 - Magic ("PKC4")
+			   4 - Entry count
+			   8 - Entries
+
+			Entry Structure (strings are a length followed by their bytes):
+			  Pack name
+			  Image stamp (64-bit)
+			  Image size (64-bit)
+			  Image stat (64-bit)
+			  Metadata length
+			  Metadata
+		*/
+		std::vector<char> data;
+		if (!Filesystem::ReadLocal("Cache/Packs.bin", data))
+			return;
+
+		const char *datap = data.data();
+		const char *data_end = datap + data.size();
+		try
+		{
+			if (Pack_Read32(datap, data_end) != PACK_CACHE_MAGIC)
+				return;
+
+			uint32_t entry_count = Pack_Read32(datap, data_end);
+			for (uint32_t i = 0; i < entry_count; i++)
+			{
+				std::string name = Pack_ReadString(datap, data_end);
+				uint64_t stamp = Pack_Read32(datap, data_end);
+				stamp |= (uint64_t)Pack_Read32(datap, data_end) << 32;
+				uint64_t size = Pack_Read32(datap, data_end);
+				size |= (uint64_t)Pack_Read32(datap, data_end) << 32;
+				uint64_t stat = Pack_Read32(datap, data_end);
+				stat |= (uint64_t)Pack_Read32(datap, data_end) << 32;
+				std::string metadata = Pack_ReadString(datap, data_end);
+				cache[name] = { stamp, size, stat, std::vector<char>(metadata.begin(), metadata.end()) };
+			}
+		}
+		catch (PaperPup::RuntimeError &exception)
+		{
+			// Ignore a damaged cache, it'll be rewritten
+			(void)exception;
+			cache.clear();
+			return;
+		}
+
+		// Carry over entries of listed packs, so unchanged packs stay cached
+		for (auto &name : names)
+		{
+			auto entry = cache.find(name);
+			if (entry != cache.end())
+				cache_out.emplace(name, entry->second);
+		}
+		cache_dirty = cache_out.size() != cache.size();
+	}
+
+	void PackLoader::WriteCache()
+	{
+		if (!cache_dirty)
+			return;
+
+		std::vector<char> data;
+		Pack_Write32(data, PACK_CACHE_MAGIC);
+		Pack_Write32(data, (uint32_t)cache_out.size());
+		for (auto &entry : cache_out)
+		{
+			Pack_WriteString(data, entry.first);
+			Pack_Write32(data, (uint32_t)(entry.second.stamp >> 0));
+			Pack_Write32(data, (uint32_t)(entry.second.stamp >> 32));
+			Pack_Write32(data, (uint32_t)(entry.second.size >> 0));
+			Pack_Write32(data, (uint32_t)(entry.second.size >> 32));
+			Pack_Write32(data, (uint32_t)(entry.second.stat >> 0));
+			Pack_Write32(data, (uint32_t)(entry.second.stat >> 32));
+			Pack_Write32(data, (uint32_t)entry.second.metadata.size());
+			data.insert(data.end(), entry.second.metadata.begin(), entry.second.metadata.end());
+		}
+		Filesystem::WriteLocal("Cache/Packs.bin", data);
+	}
+
+	bool PackLoader::ReadIndex()
+	{
+		/*
+			Pack Index Structure:
+			   0 - Magic ("PKI1")
+			   4 - Entry count
+			   8 - Metadata offset
+			   C - Entries
+			  [Metadata]
+
+			Entry Structure (strings are a length followed by their bytes):
+			  Pack name
+			  Image path
+			  Image size (64-bit)
+			  Image stamp (64-bit)
+			  Image stat (64-bit)
+			  Metadata offset, from the start of metadata
+			  Metadata length
+
+			The index is current while its modification time matches the packs folder's
+			Each entry is still checked against its image's stat, and falls back to the stamp if it changed
+		*/
+		if (!Userdata::GetBool("menu/pack_index", true))
+			return false;
+
+		uint64_t folder_time, index_time;
+		if (!Filesystem::LocalTime("Packs", folder_time) || !Filesystem::LocalTime("Packs/index", index_time) || folder_time != index_time)
+			return false;
+
+		std::vector<char> data;
+		if (!Filesystem::ReadLocal("Packs/index", data))
+			return false;
+
+		const char *datap = data.data();
+		const char *data_end = datap + data.size();
+		try
+		{
+			if (Pack_Read32(datap, data_end) != PACK_INDEX_MAGIC)
+				return false;
+
+			uint32_t entry_count = Pack_Read32(datap, data_end);
+			size_t metadata_offset = Pack_Read32(datap, data_end);
+			if (metadata_offset > data.size())
+				throw PaperPup::RuntimeError("Pack index metadata out of range");
+
+			const char *metadata = data.data() + metadata_offset;
+			size_t metadata_size = data.size() - metadata_offset;
+
+			for (uint32_t i = 0; i < entry_count; i++)
+			{
+				std::string name = Pack_ReadString(datap, data_end);
+				Pack_ReadString(datap, data_end); // Image path, always Packs/<name>/Image for now
+				uint64_t size = Pack_Read32(datap, data_end);
+				size |= (uint64_t)Pack_Read32(datap, data_end) << 32;
+				uint64_t stamp = Pack_Read32(datap, data_end);
+				stamp |= (uint64_t)Pack_Read32(datap, data_end) << 32;
+				uint64_t stat = Pack_Read32(datap, data_end);
+				stat |= (uint64_t)Pack_Read32(datap, data_end) << 32;
+				size_t entry_offset = Pack_Read32(datap, data_end);
+				size_t entry_length = Pack_Read32(datap, data_end);
+				if (entry_offset > metadata_size || entry_length > (metadata_size - entry_offset))
+					throw PaperPup::RuntimeError("Pack index metadata out of range");
+
+				names.push_back(name);
+				cache[name] = { stamp, size, stat, std::vector<char>(metadata + entry_offset, metadata + entry_offset + entry_length) };
+			}
+		}
+		catch (PaperPup::RuntimeError &exception)
+		{
+			// Ignore a damaged index, it'll be rewritten
+			(void)exception;
+			names.clear();
+			cache.clear();
+			return false;
+		}
+
+		// Indexed packs are also what the metadata cache should hold
+		cache_out = cache;
+		return true;
+	}
+
+	void PackLoader::WriteIndex()
+	{
+		// Write entries in listing order, with their metadata after
+		std::vector<char> entries, metadata;
+		uint32_t entry_count = 0;
+		for (auto &name : names)
+		{
+			auto entry = cache_out.find(name);
+			if (entry == cache_out.end())
+				continue;
+
+			Pack_WriteString(entries, name);
+			Pack_WriteString(entries, "Packs/" + name + "/Image");
+			Pack_Write32(entries, (uint32_t)(entry->second.size >> 0));
+			Pack_Write32(entries, (uint32_t)(entry->second.size >> 32));
+			Pack_Write32(entries, (uint32_t)(entry->second.stamp >> 0));
+			Pack_Write32(entries, (uint32_t)(entry->second.stamp >> 32));
+			Pack_Write32(entries, (uint32_t)(entry->second.stat >> 0));
+			Pack_Write32(entries, (uint32_t)(entry->second.stat >> 32));
+			Pack_Write32(entries, (uint32_t)metadata.size());
+			Pack_Write32(entries, (uint32_t)entry->second.metadata.size());
+			metadata.insert(metadata.end(), entry->second.metadata.begin(), entry->second.metadata.end());
+			entry_count++;
+		}
+
+		std::vector<char> data;
+		Pack_Write32(data, PACK_INDEX_MAGIC);
+		Pack_Write32(data, entry_count);
+		Pack_Write32(data, (uint32_t)(12 + entries.size()));
+		data.insert(data.end(), entries.begin(), entries.end());
+		data.insert(data.end(), metadata.begin(), metadata.end());
+		Filesystem::WriteLocal("Packs/index", data);
+
+		// Writing the index changed the folder's time, so match the index to it
+		uint64_t folder_time;
+		if (Filesystem::LocalTime("Packs", folder_time))
+			Filesystem::SetLocalTime("Packs/index", folder_time);
+	}
+}
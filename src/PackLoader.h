@@ -0,0 +1,96 @@
+/*
+ * [PaperPup]
+ *   PackLoader.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "PaperPup.h"
+
+#include "Pack.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+namespace PaperPup
+{
+	// Pack loader class
+	// Each pack has its own image and Lua controller, so packs load on a pool of worker threads
+	struct PackResult
+	{
+		// Loaded pack, or the error that stopped it loading
+		std::string name;
+		std::unique_ptr<Pack> pack;
+		std::string error;
+	};
+
+	// Pack cache constants
+	static constexpr uint32_t PACK_CACHE_MAGIC = 0x34434B50; // "PKC4"
+	static constexpr uint32_t PACK_INDEX_MAGIC = 0x31494B50; // "PKI1"
+
+	class PackLoader
+	{
+		private:
+			// Metadata cache, keyed by pack name and checked against the pack image's stamp
+			// Indexed entries are checked against the image's stat first, which doesn't list the image's folder
+			struct CacheEntry
+			{
+				uint64_t stamp, size, stat;
+				std::vector<char> metadata;
+			};
+			std::unordered_map<std::string, CacheEntry> cache;
+
+			std::mutex cache_mutex;
+			std::unordered_map<std::string, CacheEntry> cache_out;
+			bool cache_dirty = false;
+
+			// Set if Packs/index was current, its packs are listed without touching their images
+			bool index_valid = false;
+
+			// Packs to load
+			std::vector<std::string> names;
+			std::atomic<size_t> names_next{0};
+
+			// Finished packs
+			std::mutex results_mutex;
+			std::deque<PackResult> results;
+			size_t results_taken = 0;
+			std::atomic<size_t> results_done{0};
+			std::atomic<bool> results_failed{false};
+
+			// Worker threads
+			std::vector<std::thread> workers;
+			std::atomic<bool> workers_run{true};
+
+		public:
+			// Pack loader interface
+			PackLoader();
+			~PackLoader();
+
+			// Takes the next finished pack, in completion order
+			bool Poll(PackResult &result);
+			bool Done() const { return results_taken == names.size(); }
+
+		private:
+			void Work();
+			Pack *Load(const std::string &name);
+
+			void ReadCache();
+			void WriteCache();
+
+			bool ReadIndex();
+			void WriteIndex();
+	};
+}
@@ -0,0 +1,385 @@
+/*
+ * [PaperPup]
+ *   Atlas.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "Platform/Render.h"
+#include "Platform/Filesystem.h"
+
+#include "Platform/Common/Hash.h"
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+
+namespace PaperPup
+{
+	namespace Render
+	{
+		// Atlas constants
+		static constexpr unsigned int ATLAS_PAGE_SIZE = 1024;
+		static constexpr unsigned int ATLAS_PADDING = 2; // Edge pixels extruded around each image, so filtering never samples a neighbour
+		static constexpr uint32_t ATLAS_CACHE_MAGIC = 0x314C5441; // "ATL1"
+
+		// Skyline packer
+		class Skyline
+		{
+			private:
+				// Skyline segments, ordered left to right
+				struct Segment
+				{
+					unsigned int x, y, w;
+				};
+				std::vector<Segment> segments;
+
+				unsigned int width, height;
+
+			public:
+				// Skyline interface
+				Skyline(unsigned int _width, unsigned int _height) : width(_width), height(_height)
+				{
+					segments.push_back({ 0, 0, width });
+				}
+
+				bool Insert(unsigned int w, unsigned int h, unsigned int *out_x, unsigned int *out_y)
+				{
+					// Find the segment giving the lowest top edge, then the leftmost
+					size_t best = segments.size();
+					unsigned int best_y = height, best_w = width;
+
+					for (size_t i = 0; i < segments.size(); i++)
+					{
+						unsigned int y;
+						if (!Fit(i, w, h, &y))
+							continue;
+						if (y < best_y || (y == best_y && segments[i].w < best_w))
+						{
+							best = i;
+							best_y = y;
+							best_w = segments[i].w;
+						}
+					}
+					if (best == segments.size())
+						return false;
+
+					// Raise skyline under the placed rectangle
+					unsigned int x = segments[best].x;
+					segments.insert(segments.begin() + best, { x, best_y + h, w });
+
+					for (size_t i = best + 1; i < segments.size();)
+					{
+						Segment &segment = segments[i];
+						unsigned int covered_end = x + w;
+						if (segment.x >= covered_end)
+							break;
+
+						unsigned int shrink = covered_end - segment.x;
+						if (shrink >= segment.w)
+						{
+							segments.erase(segments.begin() + i);
+							continue;
+						}
+						segment.x += shrink;
+						segment.w -= shrink;
+						break;
+					}
+
+					// Merge neighbouring segments of equal height
+					for (size_t i = 0; i + 1 < segments.size();)
+					{
+						if (segments[i].y == segments[i + 1].y)
+						{
+							segments[i].w += segments[i + 1].w;
+							segments.erase(segments.begin() + i + 1);
+						}
+						else
+						{
+							i++;
+						}
+					}
+
+					*out_x = x;
+					*out_y = best_y;
+					return true;
+				}
+
+			private:
+				bool Fit(size_t index, unsigned int w, unsigned int h, unsigned int *out_y) const
+				{
+					// Check rectangle fits horizontally
+					unsigned int x = segments[index].x;
+					if (x + w > width)
+						return false;
+
+					// Rest on the highest segment spanned
+					unsigned int y = 0;
+					unsigned int remaining = w;
+					for (size_t i = index; remaining > 0; i++)
+					{
+						y = std::max(y, segments[i].y);
+						if (y + h > height)
+							return false;
+						remaining -= std::min(remaining, segments[i].w);
+					}
+
+					*out_y = y;
+					return true;
+				}
+		};
+
+		// Atlas class
+		struct AtlasRect
+		{
+			unsigned int page;
+			unsigned int x, y, w, h;
+			float u0, v0, u1, v1;
+		};
+
+		class Atlas
+		{
+			private:
+				// Page size
+				unsigned int page_width, page_height;
+
+				// Added images
+				struct Entry
+				{
+					std::string name;
+					unsigned int w, h;
+					const uint16_t *data;
+					AtlasRect rect;
+				};
+				std::vector<Entry> entries;
+				std::unordered_map<std::string, size_t> entry_map;
+
+				// Uploaded pages
+				std::vector<std::unique_ptr<Texture>> pages;
+
+			public:
+				// Atlas interface
+				Atlas(unsigned int _page_width = ATLAS_PAGE_SIZE, unsigned int _page_height = ATLAS_PAGE_SIZE) : page_width(_page_width), page_height(_page_height) {}
+				~Atlas() {}
+
+				void Add(std::string name, unsigned int w, unsigned int h, const uint16_t *data)
+				{
+					// Image data is referenced, not copied, and must stay valid until Build
+					if (!Fits(w, h))
+						throw PaperPup::RuntimeError("Atlas image " + name + " doesn't fit in a page");
+					if (entry_map.find(name) != entry_map.end())
+						throw PaperPup::RuntimeError("Atlas image " + name + " added twice");
+
+					entry_map.emplace(name, entries.size());
+					entries.push_back({ name, w, h, data, {} });
+				}
+
+				void Build(std::string cache_name)
+				{
+					// Use cached layout if our images haven't changed, otherwise pack and cache a new one
+					std::string cache_path = "Cache/Atlas/" + cache_name + ".bin";
+					uint64_t layout_hash = LayoutHash();
+
+					unsigned int page_count;
+					if (!ReadLayout(cache_path, layout_hash, &page_count))
+					{
+						page_count = Pack();
+						WriteLayout(cache_path, layout_hash);
+					}
+
+					// Compose and upload pages
+					pages.clear();
+					std::vector<uint16_t> page_data((size_t)page_width * page_height);
+					for (unsigned int i = 0; i < page_count; i++)
+					{
+						std::fill(page_data.begin(), page_data.end(), 0);
+						for (auto &entry : entries)
+						{
+							if (entry.rect.page != i)
+								continue;
+							// Extrude the image's edges into its padding
+							for (unsigned int j = 0; j < entry.h + ATLAS_PADDING * 2; j++)
+							{
+								unsigned int src_y = std::min(std::max(j, ATLAS_PADDING) - ATLAS_PADDING, entry.h - 1);
+								const uint16_t *src = entry.data + (size_t)src_y * entry.w;
+								uint16_t *dst = &page_data[(size_t)(entry.rect.y - ATLAS_PADDING + j) * page_width + (entry.rect.x - ATLAS_PADDING)];
+
+								std::fill(dst, dst + ATLAS_PADDING, src[0]);
+								std::memcpy(dst + ATLAS_PADDING, src, entry.w * sizeof(uint16_t));
+								std::fill(dst + ATLAS_PADDING + entry.w, dst + ATLAS_PADDING * 2 + entry.w, src[entry.w - 1]);
+							}
+						}
+						pages.emplace_back(Texture::New(TextureBind::Resource, page_width, page_height, page_data.data()));
+					}
+
+					// Image data is no longer referenced
+					for (auto &entry : entries)
+						entry.data = nullptr;
+				}
+
+				bool Fits(unsigned int w, unsigned int h) const
+				{
+					return w != 0 && h != 0 && w + ATLAS_PADDING * 2 <= page_width && h + ATLAS_PADDING * 2 <= page_height;
+				}
+
+				const AtlasRect *Find(std::string name) const
+				{
+					auto entry = entry_map.find(name);
+					if (entry == entry_map.end())
+						return nullptr;
+					return &entries[entry->second].rect;
+				}
+
+				size_t Pages() const
+				{
+					return pages.size();
+				}
+
+				Texture *Page(unsigned int page) const
+				{
+					return pages[page].get();
+				}
+
+			private:
+				uint64_t LayoutHash() const
+				{
+					// Layout depends on page size, padding, and the name and size of every image
+					uint64_t hash = Hash::FNV1a(page_width);
+					hash = Hash::FNV1a(page_height, hash);
+					hash = Hash::FNV1a(ATLAS_PADDING, hash);
+					for (auto &entry : entries)
+					{
+						hash = Hash::FNV1a(entry.name, hash);
+						hash = Hash::FNV1a(entry.w, hash);
+						hash = Hash::FNV1a(entry.h, hash);
+					}
+					return hash;
+				}
+
+				void SetRect(Entry &entry, unsigned int page, unsigned int x, unsigned int y)
+				{
+					entry.rect.page = page;
+					entry.rect.x = x;
+					entry.rect.y = y;
+					entry.rect.w = entry.w;
+					entry.rect.h = entry.h;
+					entry.rect.u0 = (float)x / page_width;
+					entry.rect.v0 = (float)y / page_height;
+					entry.rect.u1 = (float)(x + entry.w) / page_width;
+					entry.rect.v1 = (float)(y + entry.h) / page_height;
+				}
+
+				unsigned int Pack()
+				{
+					// Pack tallest images first
+					std::vector<size_t> order(entries.size());
+					for (size_t i = 0; i < order.size(); i++)
+						order[i] = i;
+					std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+					{
+						if (entries[a].h != entries[b].h)
+							return entries[a].h > entries[b].h;
+						return entries[a].w > entries[b].w;
+					});
+
+					// Place each padded image into the first page it fits, opening pages as needed
+					std::vector<Skyline> skylines;
+					for (size_t i : order)
+					{
+						Entry &entry = entries[i];
+						unsigned int cell_w = entry.w + ATLAS_PADDING * 2, cell_h = entry.h + ATLAS_PADDING * 2;
+						unsigned int x, y;
+
+						size_t page = 0;
+						for (; page < skylines.size(); page++)
+						{
+							if (skylines[page].Insert(cell_w, cell_h, &x, &y))
+								break;
+						}
+						if (page == skylines.size())
+						{
+							skylines.emplace_back(page_width, page_height);
+							if (!skylines.back().Insert(cell_w, cell_h, &x, &y))
+								throw PaperPup::RuntimeError("Atlas image " + entry.name + " doesn't fit in a page");
+						}
+
+						SetRect(entry, (unsigned int)page, x + ATLAS_PADDING, y + ATLAS_PADDING);
+					}
+					return (unsigned int)skylines.size();
+				}
+
+				bool ReadLayout(std::string path, uint64_t layout_hash, unsigned int *page_count)
+				{
+					/*
+						Atlas Cache Structure:
+						   0 - Magic ("ATL1")
+						   4 - Layout hash (64-bit)
+						   C - Page count
+						  10 - Image count
+						  14 - Rects (page, x, y per image, in add order)
+
+						Positions are of the image itself, its padding surrounds it
+					*/
+					std::vector<char> layout;
+					if (!Filesystem::ReadLocal(path, layout) || layout.size() < 0x14)
+						return false;
+
+					char *layoutp = layout.data();
+					uint64_t hash = (uint64_t)Filesystem::Read32(layoutp + 0x04) | ((uint64_t)Filesystem::Read32(layoutp + 0x08) << 32);
+					if (Filesystem::Read32(layoutp + 0x00) != ATLAS_CACHE_MAGIC || hash != layout_hash)
+						return false;
+
+					*page_count = Filesystem::Read32(layoutp + 0x0C);
+					if (Filesystem::Read32(layoutp + 0x10) != entries.size() || layout.size() != 0x14 + entries.size() * 12)
+						return false;
+
+					layoutp += 0x14;
+					for (auto &entry : entries)
+					{
+						unsigned int page = Filesystem::Read32(layoutp + 0);
+						unsigned int x = Filesystem::Read32(layoutp + 4);
+						unsigned int y = Filesystem::Read32(layoutp + 8);
+						if (page >= *page_count || x < ATLAS_PADDING || y < ATLAS_PADDING || x + entry.w + ATLAS_PADDING > page_width || y + entry.h + ATLAS_PADDING > page_height)
+							return false;
+						SetRect(entry, page, x, y);
+						layoutp += 12;
+					}
+					return true;
+				}
+
+				void WriteLayout(std::string path, uint64_t layout_hash)
+				{
+					std::vector<char> layout;
+					auto Write32 = [&](uint32_t value)
+					{
+						layout.push_back(value >> 0); layout.push_back(value >> 8); layout.push_back(value >> 16); layout.push_back(value >> 24);
+					};
+
+					unsigned int page_count = 0;
+					for (auto &entry : entries)
+						page_count = std::max(page_count, entry.rect.page + 1);
+
+					Write32(ATLAS_CACHE_MAGIC);
+					Write32((uint32_t)(layout_hash >> 0));
+					Write32((uint32_t)(layout_hash >> 32));
+					Write32(page_count);
+					Write32((uint32_t)entries.size());
+					for (auto &entry : entries)
+					{
+						Write32(entry.rect.page);
+						Write32(entry.rect.x);
+						Write32(entry.rect.y);
+					}
+
+					Filesystem::WriteLocal(path, layout);
+				}
+		};
+	}
+}
@@ -13,6 +13,7 @@
 
 #include "Platform/Filesystem.h"
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 #include <memory>
@@ -43,6 +44,11 @@ namespace PaperPup
 				// Binary interface
 				virtual ~Binary() {}
 
+				const std::unordered_map<std::string, Binary_Directory> &Directory() const
+				{
+					return directory;
+				}
+
 				File *OpenFile(std::string name, bool mode2)
 				{
 					// Get directory
@@ -83,6 +89,39 @@ namespace PaperPup
 					return nullptr;
 				}
 
+				File *OpenFileRange(std::string name, size_t offset, size_t length)
+				{
+					// Get directory
+					auto dir = directory.find(name);
+					if (dir == directory.end() || offset > dir->second.size)
+						return nullptr;
+					length = std::min<size_t>(length, dir->second.size - offset);
+
+					// Read only the sectors covering the range
+					uint32_t sector_start = (uint32_t)(offset / SECTOR_MODE1);
+					uint32_t sector_end = (uint32_t)((offset + length + 0x7FF) / SECTOR_MODE1);
+					size_t sector_offset = offset % SECTOR_MODE1;
+
+					char *data = new char[length];
+					char *datap = data;
+					size_t remaining = length;
+
+					SeekLBA(dir->second.lba + sector_start);
+					for (uint32_t i = sector_start; i < sector_end; i++)
+					{
+						char sector[SECTOR_MODE2];
+						ReadSector(sector, 1);
+
+						size_t copy = std::min<size_t>(remaining, SECTOR_MODE1 - sector_offset);
+						std::memcpy(datap, sector + 0x018 + sector_offset, copy);
+						datap += copy;
+						remaining -= copy;
+						sector_offset = 0;
+					}
+
+					return new File(data, length);
+				}
+
 				void ParseDirectory()
 				{
 					// Primary volume descriptor data
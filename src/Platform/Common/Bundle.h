@@ -0,0 +1,215 @@
+/*
+ * [PaperPup]
+ *   Bundle.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "Platform/Filesystem.h"
+
+#include <unordered_map>
+#include <memory>
+#include <cstdio>
+
+namespace PaperPup
+{
+	namespace Filesystem
+	{
+		// Bundle constants
+		static constexpr uint32_t BUNDLE_MAGIC = 0x4E425050; // "PPBN"
+		static constexpr uint32_t BUNDLE_VERSION = 3;
+		static constexpr uint32_t BUNDLE_ALIGN = 0x800;
+
+		static constexpr uint32_t BUNDLE_TYPE_DATA = 0; // File data, as read in mode 1
+		static constexpr uint32_t BUNDLE_TYPE_MODE2 = 1; // Raw mode 2 sectors
+		static constexpr uint32_t BUNDLE_TYPE_BYTECODE = 2; // Compiled Luau bytecode, after its compile options
+		static constexpr uint32_t BUNDLE_TYPE_TEXTURE = 3; // Decoded TIM, see TIM::Serialize
+		static constexpr uint32_t BUNDLE_TYPES = 4;
+
+		/*
+			Bundle Structure:
+			   0 - Magic ("PPBN")
+			   4 - Version
+			   8 - Directory offset
+			   C - Directory entry count
+			  [Entry data, each aligned to BUNDLE_ALIGN]
+			  [Directory]
+
+			Directory Entry Structure:
+			   0 - Data offset
+			   4 - Data size
+			   8 - Type
+			   C - Name length
+			  10 - Name (padded to 4 bytes)
+
+			Bytecode Entry Structure:
+			   0 - Optimization level
+			   1 - Debug level
+			   2 - Reserved (halfword)
+			   4 - Bytecode
+		*/
+		static constexpr size_t BUNDLE_BYTECODE_HEADER = 4;
+
+		// Bundle class
+		struct Bundle_Directory
+		{
+			const char *data[BUNDLE_TYPES] = {};
+			size_t size[BUNDLE_TYPES] = {};
+		};
+
+		class Bundle
+		{
+			private:
+				// Bundle memory
+				const char *data;
+				size_t size;
+				std::shared_ptr<const void> hold;
+
+				// File directory
+				std::unordered_map<std::string, Bundle_Directory> directory;
+
+			public:
+				// Bundle interface
+				Bundle(const char *_data, size_t _size, std::shared_ptr<const void> _hold) : data(_data), size(_size), hold(_hold)
+				{
+					// Read header
+					if (size < 0x10 || Read32(data + 0x0) != BUNDLE_MAGIC)
+						throw PaperPup::RuntimeError("Bundle invalid header");
+					if (Read32(data + 0x4) != BUNDLE_VERSION)
+						throw PaperPup::RuntimeError("Bundle version mismatch");
+
+					size_t dir_offset = Read32(data + 0x8);
+					uint32_t dir_count = Read32(data + 0xC);
+
+					// Read directory
+					const char *dirp = data + dir_offset;
+					const char *data_end = data + size;
+					if (dir_offset > size)
+						throw PaperPup::RuntimeError("Bundle directory out of range");
+
+					for (uint32_t i = 0; i < dir_count; i++)
+					{
+						if ((data_end - dirp) < 0x10)
+							throw PaperPup::RuntimeError("Bundle directory out of range");
+						size_t entry_offset = Read32(dirp + 0x0);
+						size_t entry_size = Read32(dirp + 0x4);
+						uint32_t entry_type = Read32(dirp + 0x8);
+						size_t name_length = Read32(dirp + 0xC);
+
+						size_t entry_length = 0x10 + ((name_length + 3) & ~3);
+						if (entry_length > (size_t)(data_end - dirp) || entry_type >= BUNDLE_TYPES || entry_offset > size || entry_size > (size - entry_offset))
+							throw PaperPup::RuntimeError("Bundle directory entry out of range");
+
+						Bundle_Directory &dir = directory[std::string(dirp + 0x10, name_length)];
+						dir.data[entry_type] = data + entry_offset;
+						dir.size[entry_type] = entry_size;
+
+						dirp += entry_length;
+					}
+				}
+
+				~Bundle()
+				{
+
+				}
+
+				File *OpenFile(std::string name, uint32_t type)
+				{
+					// Get directory
+					auto dir = directory.find(name);
+					if (dir == directory.end() || dir->second.data[type] == nullptr)
+						return nullptr;
+
+					// Borrow bundle memory
+					return new File(dir->second.data[type], dir->second.size[type], hold);
+				}
+		};
+
+		// Bundle writer class
+		class BundleWriter
+		{
+			private:
+				// Output file
+				std::FILE *handle;
+				size_t offset = 0;
+
+				// Written directory
+				std::vector<char> directory;
+				uint32_t directory_count = 0;
+
+			public:
+				// Bundle writer interface
+				BundleWriter(std::FILE *_handle) : handle(_handle)
+				{
+					// Reserve header, patched in Finish
+					char header[0x10] = {};
+					Write(header, sizeof(header));
+					Align();
+				}
+
+				~BundleWriter()
+				{
+
+				}
+
+				void Add(std::string name, uint32_t type, const char *data, size_t size)
+				{
+					// Write directory entry
+					Write32(directory, (uint32_t)offset);
+					Write32(directory, (uint32_t)size);
+					Write32(directory, type);
+					Write32(directory, (uint32_t)name.size());
+					directory.insert(directory.end(), name.begin(), name.end());
+					while (directory.size() & 3)
+						directory.push_back('\0');
+					directory_count++;
+
+					// Write entry data
+					Write(data, size);
+					Align();
+				}
+
+				void Finish()
+				{
+					// Write directory
+					uint32_t directory_offset = (uint32_t)offset;
+					Write(directory.data(), directory.size());
+
+					// Patch header
+					std::vector<char> header;
+					Write32(header, BUNDLE_MAGIC);
+					Write32(header, BUNDLE_VERSION);
+					Write32(header, directory_offset);
+					Write32(header, directory_count);
+
+					if (std::fseek(handle, 0, SEEK_SET) != 0 || std::fwrite(header.data(), 1, header.size(), handle) != header.size())
+						throw PaperPup::RuntimeError("Bundle failed to write header");
+				}
+
+			private:
+				static void Write32(std::vector<char> &out, uint32_t value)
+				{
+					out.push_back(value >> 0); out.push_back(value >> 8); out.push_back(value >> 16); out.push_back(value >> 24);
+				}
+
+				void Write(const char *data, size_t size)
+				{
+					if (size != 0 && std::fwrite(data, 1, size, handle) != size)
+						throw PaperPup::RuntimeError("Bundle failed to write data");
+					offset += size;
+				}
+
+				void Align()
+				{
+					static const char zero[BUNDLE_ALIGN] = {};
+					Write(zero, (BUNDLE_ALIGN - (offset % BUNDLE_ALIGN)) % BUNDLE_ALIGN);
+				}
+		};
+	}
+}
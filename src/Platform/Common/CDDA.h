@@ -0,0 +1,237 @@
+/*
+ * [PaperPup]
+ *   CDDA.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "Platform/Audio.h"
+#include "Platform/Common/Binary.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+
+namespace PaperPup
+{
+	namespace CDDA
+	{
+		// CDDA constants
+		static constexpr unsigned int SAMPLE_RATE = 44100;
+		static constexpr unsigned int SECTOR_FRAMES = Filesystem::SECTOR_MODE2 / 4;
+
+		static constexpr size_t RING_FRAMES = 1 << 15; // ~0.74 seconds
+		static constexpr uint32_t READ_SECTORS = 16;
+
+		// CDDA sector reader
+		class Reader
+		{
+			public:
+				// Reader interface, called from the streaming thread only
+				virtual ~Reader() {}
+
+				virtual uint32_t Sectors() = 0;
+				virtual bool ReadSectors(uint32_t lba, uint32_t count, char *data) = 0;
+		};
+
+		// CDDA track
+		class Track : public Audio::SoundSource
+		{
+			private:
+				// Sector reader
+				std::unique_ptr<Reader> reader;
+
+				// Ring of stereo frames, written by the streaming thread and read by the audio thread
+				std::unique_ptr<int16_t[]> ring;
+				std::atomic<size_t> ring_read{0}, ring_write{0};
+
+				// Streaming thread
+				std::thread thread;
+				std::atomic<bool> thread_run{false};
+				std::atomic<bool> thread_end{false};
+
+				// Playback state
+				bool on = false;
+				std::atomic<bool> loop{false};
+
+				unsigned long long subposition = 0;
+				int16_t frame_cur[2] = {}, frame_next[2] = {};
+
+				short vol_l = 0x4000, vol_r = 0x4000;
+
+			public:
+				// Track interface
+				Track(Reader *_reader) : reader(_reader), ring(std::make_unique<int16_t[]>(RING_FRAMES * 2)) {}
+				~Track()
+				{
+					// Stop streaming thread
+					StopThread();
+				}
+
+				void SetLoop(bool _loop)
+				{
+					// Set track loop
+					loop = _loop;
+				}
+
+				void SetVolume(short _vol_l, short _vol_r)
+				{
+					// Set track volume
+					vol_l = _vol_l;
+					vol_r = _vol_r;
+				}
+
+				void Play() override
+				{
+					// Restart stream from the beginning of the track
+					StopThread();
+					ring_read = 0;
+					ring_write = 0;
+					thread_end = false;
+					thread_run = true;
+					thread = std::thread(&Track::Stream, this);
+
+					// Turn on
+					on = true;
+					subposition = 0;
+					frame_cur[0] = frame_cur[1] = 0;
+					frame_next[0] = frame_next[1] = 0;
+				}
+
+				void Stop() override
+				{
+					// Turn off
+					on = false;
+					StopThread();
+				}
+
+				void Decode(unsigned long out_sample_rate, int16_t *out, size_t frames) override
+				{
+					// Decode samples
+					auto OutSample = [&](long s)
+					{
+						if (s < -0x7FFF)
+							*out++ = -0x7FFF;
+						else if (s > 0x7FFF)
+							*out++ = 0x7FFF;
+						else
+							*out++ = (int16_t)s;
+					};
+
+					unsigned long long subposition_inc = ((unsigned long long)SAMPLE_RATE << 32) / out_sample_rate;
+
+					size_t i = 0;
+					for (; on && i < frames; i++)
+					{
+						// Interpolate between current and next frame
+						long long frac = (long long)(subposition & 0xFFFFFFFF);
+						long l = frame_cur[0] + (long)(((frame_next[0] - frame_cur[0]) * frac) >> 32);
+						long r = frame_cur[1] + (long)(((frame_next[1] - frame_cur[1]) * frac) >> 32);
+
+						// Output sample
+						OutSample((l * vol_l) >> 14);
+						OutSample((r * vol_r) >> 14);
+
+						// Advance through ring
+						subposition += subposition_inc;
+						while (subposition >> 32)
+						{
+							subposition -= 1ULL << 32;
+							frame_cur[0] = frame_next[0];
+							frame_cur[1] = frame_next[1];
+							if (!PopFrame(frame_next))
+							{
+								// Fill underruns with silence, and turn off once the stream has ended
+								frame_next[0] = frame_next[1] = 0;
+								if (thread_end.load(std::memory_order_acquire) && !PopFrame(frame_next))
+									on = false;
+							}
+						}
+					}
+
+					// Clear remaining output
+					for (; i < frames; i++)
+					{
+						*out++ = 0;
+						*out++ = 0;
+					}
+				}
+
+			private:
+				bool PopFrame(int16_t *frame)
+				{
+					// Check for available frame
+					size_t read = ring_read.load(std::memory_order_relaxed);
+					if (read == ring_write.load(std::memory_order_acquire))
+						return false;
+
+					// Read frame
+					frame[0] = ring[(read % RING_FRAMES) * 2 + 0];
+					frame[1] = ring[(read % RING_FRAMES) * 2 + 1];
+					ring_read.store(read + 1, std::memory_order_release);
+					return true;
+				}
+
+				void StopThread()
+				{
+					thread_run = false;
+					if (thread.joinable())
+						thread.join();
+				}
+
+				void Stream()
+				{
+					// Stream sectors into ring
+					std::unique_ptr<char[]> sectors = std::make_unique<char[]>(READ_SECTORS * Filesystem::SECTOR_MODE2);
+					uint32_t lba = 0, lba_end = reader->Sectors();
+
+					while (thread_run)
+					{
+						// Wait for space in ring
+						size_t write = ring_write.load(std::memory_order_relaxed);
+						size_t space = RING_FRAMES - (write - ring_read.load(std::memory_order_acquire));
+						if (space < SECTOR_FRAMES)
+						{
+							std::this_thread::sleep_for(std::chrono::milliseconds(2));
+							continue;
+						}
+
+						// Handle end of track
+						if (lba >= lba_end)
+						{
+							if (!loop || lba_end == 0)
+								break;
+							lba = 0;
+						}
+
+						// Read sectors
+						uint32_t count = (uint32_t)std::min<size_t>({ (size_t)READ_SECTORS, space / SECTOR_FRAMES, (size_t)(lba_end - lba) });
+						if (!reader->ReadSectors(lba, count, sectors.get()))
+							break;
+						lba += count;
+
+						// Write frames
+						const char *samplep = sectors.get();
+						for (size_t i = 0; i < (size_t)count * SECTOR_FRAMES; i++, write++)
+						{
+							ring[(write % RING_FRAMES) * 2 + 0] = (int16_t)Filesystem::Read16(samplep + 0);
+							ring[(write % RING_FRAMES) * 2 + 1] = (int16_t)Filesystem::Read16(samplep + 2);
+							samplep += 4;
+						}
+						ring_write.store(write, std::memory_order_release);
+					}
+
+					// Mark end of stream
+					thread_end = true;
+				}
+		};
+	}
+}
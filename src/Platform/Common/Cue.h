@@ -0,0 +1,130 @@
+/*
+ * [PaperPup]
+ *   Cue.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "Platform/Filesystem.h"
+
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+
+namespace PaperPup
+{
+	namespace Filesystem
+	{
+		// Cue constants
+		static constexpr unsigned int CUE_FRAMES_PER_SECOND = 75;
+
+		// Cue track
+		struct Cue_Track
+		{
+			// Track number and file
+			unsigned int number = 0;
+			std::string file;
+
+			// Track type
+			bool audio = false;
+			bool mode2 = false;
+
+			// Sectors in file, end of 0 runs to end of file
+			uint32_t start = 0, end = 0;
+		};
+
+		// Cue parser
+		static std::vector<Cue_Track> ParseCue(const std::string &cue)
+		{
+			std::vector<Cue_Track> tracks;
+			std::string file;
+
+			auto ReadMSF = [](std::string msf)
+			{
+				unsigned int m = 0, s = 0, f = 0;
+				char sep0 = 0, sep1 = 0;
+				std::istringstream msf_stream(msf);
+				if (!(msf_stream >> m >> sep0 >> s >> sep1 >> f) || sep0 != ':' || sep1 != ':')
+					throw PaperPup::RuntimeError("Cue invalid index " + msf);
+				return (uint32_t)((m * 60 + s) * CUE_FRAMES_PER_SECOND + f);
+			};
+
+			auto EndTrack = [&](uint32_t end)
+			{
+				// Close the previous track if it shares our file
+				if (!tracks.empty() && tracks.back().file == file && tracks.back().end == 0)
+					tracks.back().end = end;
+			};
+
+			std::istringstream cue_stream(cue);
+			std::string line;
+			while (std::getline(cue_stream, line))
+			{
+				// Read command
+				std::istringstream line_stream(line);
+				std::string command;
+				if (!(line_stream >> command))
+					continue;
+				std::transform(command.begin(), command.end(), command.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+
+				if (command == "FILE")
+				{
+					// Read file name, which may be quoted
+					line_stream >> std::ws;
+					if (line_stream.peek() == '"')
+					{
+						line_stream.get();
+						std::getline(line_stream, file, '"');
+					}
+					else
+					{
+						line_stream >> file;
+					}
+				}
+				else if (command == "TRACK")
+				{
+					// Read track number and type
+					Cue_Track track;
+					std::string type;
+					if (!(line_stream >> track.number >> type))
+						throw PaperPup::RuntimeError("Cue invalid track");
+					std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return (char)std::toupper(c); });
+
+					track.file = file;
+					track.audio = (type == "AUDIO");
+					track.mode2 = (type == "MODE2/2352");
+					tracks.push_back(track);
+				}
+				else if (command == "INDEX")
+				{
+					// Read index
+					unsigned int index;
+					std::string msf;
+					if (tracks.empty() || !(line_stream >> index >> msf))
+						throw PaperPup::RuntimeError("Cue index outside of track");
+
+					// INDEX 00 pregaps are left in the previous track's playback
+					uint32_t lba = ReadMSF(msf);
+					if (index == 1)
+					{
+						Cue_Track track = tracks.back();
+						tracks.pop_back();
+						EndTrack(lba);
+
+						track.start = lba;
+						tracks.push_back(track);
+					}
+				}
+			}
+
+			return tracks;
+		}
+	}
+}
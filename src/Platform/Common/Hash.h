@@ -0,0 +1,51 @@
+/*
+ * [PaperPup]
+ *   Hash.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace PaperPup
+{
+	namespace Hash
+	{
+		// FNV-1a constants
+		static constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ULL;
+		static constexpr uint64_t FNV_PRIME = 0x00000100000001B3ULL;
+
+		// Hash functions
+		static uint64_t FNV1a(const void *data, size_t size, uint64_t hash = FNV_OFFSET)
+		{
+			const unsigned char *datap = (const unsigned char*)data;
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= datap[i];
+				hash *= FNV_PRIME;
+			}
+			return hash;
+		}
+
+		static uint64_t FNV1a(const std::string &string, uint64_t hash = FNV_OFFSET)
+		{
+			// Hash string contents followed by a terminator, so concatenations don't collide
+			hash = FNV1a(string.data(), string.size(), hash);
+			return FNV1a("", 1, hash);
+		}
+
+		static uint64_t FNV1a(uint32_t value, uint64_t hash = FNV_OFFSET)
+		{
+			unsigned char bytes[4] = { (unsigned char)(value >> 0), (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24) };
+			return FNV1a(bytes, 4, hash);
+		}
+	}
+}
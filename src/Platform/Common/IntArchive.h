@@ -23,10 +23,15 @@ namespace PaperPup
 		// Int archive constants
 		static constexpr unsigned int INT_BLOCK_SIZE = 4 << 11;
 
+		static constexpr uint32_t INT_TYPE_TIM = 1;
+		static constexpr uint32_t INT_TYPE_VAB = 2;
+		static constexpr uint32_t INT_TYPE_MEM = 3;
+
 		// Int archive class
 		struct IntArchive_Directory
 		{
 			size_t offset, size;
+			uint32_t type;
 		};
 
 		class IntArchive
@@ -60,9 +65,9 @@ namespace PaperPup
 							break;
 						switch (block_type)
 						{
-							case 1: // TIM
-							case 2: // VAB
-							case 3: // MEM
+							case INT_TYPE_TIM:
+							case INT_TYPE_VAB:
+							case INT_TYPE_MEM:
 								break;
 							default:
 								throw PaperPup::RuntimeError("Archive unrecognized block type");
@@ -88,7 +93,7 @@ namespace PaperPup
 								throw PaperPup::RuntimeError("Archive block data doesn't fit in allocated size");
 							
 							// Emplace directory
-							directory.emplace(std::make_pair<std::string, IntArchive_Directory>(dir_name, { file->Tell() + file_offset, dir_size }));
+							directory.emplace(std::make_pair<std::string, IntArchive_Directory>(dir_name, { file->Tell() + file_offset, dir_size, block_type }));
 
 							// Index next file
 							dirp += 0x14;
@@ -115,6 +120,14 @@ namespace PaperPup
 					if (dir == directory.end())
 						return nullptr;
 
+					// Borrow from archives backed by shared memory
+					if (file->Hold() != nullptr)
+					{
+						if (dir->second.offset > file->Size() || dir->second.size > (file->Size() - dir->second.offset))
+							throw PaperPup::RuntimeError("Archive failed to read file data");
+						return new File(file->Data() + dir->second.offset, dir->second.size, file->Hold());
+					}
+
 					// Read file data
 					char *data = new char[dir->second.size];
 					if (file->Seek(dir->second.offset) == false || file->Read(data, dir->second.size) != dir->second.size)
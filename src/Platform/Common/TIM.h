@@ -0,0 +1,209 @@
+/*
+ * [PaperPup]
+ *   TIM.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "Platform/Filesystem.h"
+
+#include <vector>
+
+namespace PaperPup
+{
+	namespace TIM
+	{
+		// TIM constants
+		static constexpr uint32_t ID = 0x10;
+
+		enum Flags
+		{
+			ModeMask = (3 << 0),
+			HasCLUT = (1 << 3)
+		};
+
+		enum Mode
+		{
+			Mode4 = 0,
+			Mode8 = 1,
+			Mode16 = 2,
+			Mode24 = 3
+		};
+
+		// TIM image
+		struct Image
+		{
+			// VRAM position of image data
+			unsigned int x = 0, y = 0;
+
+			// Decoded 16-bit pixels
+			unsigned int width = 0, height = 0;
+			std::vector<uint16_t> data;
+		};
+
+		/*
+			Decoded Image Structure:
+			  0 - X, Y (halfwords)
+			  4 - Width, Height (halfwords)
+			  8 - Pixels (16-bit)
+		*/
+		static std::vector<char> Serialize(const Image &image)
+		{
+			// Write header
+			std::vector<char> out;
+			auto Write16 = [&](unsigned int value) { out.push_back((char)(value >> 0)); out.push_back((char)(value >> 8)); };
+			Write16(image.x);
+			Write16(image.y);
+			Write16(image.width);
+			Write16(image.height);
+
+			// Write pixels
+			for (uint16_t pixel : image.data)
+				Write16(pixel);
+			return out;
+		}
+
+		static Image Deserialize(const char *data, size_t size)
+		{
+			// Read header
+			if (size < 8)
+				throw PaperPup::RuntimeError("Decoded TIM invalid header");
+			Image image;
+			image.x = Filesystem::Read16(data + 0);
+			image.y = Filesystem::Read16(data + 2);
+			image.width = Filesystem::Read16(data + 4);
+			image.height = Filesystem::Read16(data + 6);
+			if (((size_t)image.width * image.height * 2) > (size - 8))
+				throw PaperPup::RuntimeError("Decoded TIM out of range");
+
+			// Read pixels
+			image.data.resize((size_t)image.width * image.height);
+			for (size_t i = 0; i < image.data.size(); i++)
+				image.data[i] = Filesystem::Read16(data + 8 + i * 2);
+			return image;
+		}
+
+		/*
+			TIM Structure:
+			  0 - ID (0x10)
+			  4 - Flags (mode, CLUT present)
+			[CLUT block, if present]
+			  Image block
+
+			Block Structure:
+			  0 - Block length, including this header
+			  4 - X, Y (halfwords)
+			  8 - Width, Height (halfwords, width in 16-bit units)
+			  C - Data
+		*/
+		static Image Decode(char *data, size_t size, unsigned int clut = 0)
+		{
+			// Read header
+			if (size < 8 || Filesystem::Read32(data + 0) != ID)
+				throw PaperPup::RuntimeError("TIM invalid header");
+			uint32_t flags = Filesystem::Read32(data + 4);
+			uint32_t mode = flags & Flags::ModeMask;
+
+			char *datap = data + 8;
+			char *data_end = data + size;
+
+			auto ReadBlock = [&](uint16_t *x, uint16_t *y, uint16_t *w, uint16_t *h)
+			{
+				// Read block header
+				if ((data_end - datap) < 12)
+					throw PaperPup::RuntimeError("TIM block header out of range");
+				uint32_t block_length = Filesystem::Read32(datap + 0);
+				*x = Filesystem::Read16(datap + 4);
+				*y = Filesystem::Read16(datap + 6);
+				*w = Filesystem::Read16(datap + 8);
+				*h = Filesystem::Read16(datap + 10);
+
+				if (block_length < 12 || block_length > (size_t)(data_end - datap) || ((size_t)*w * *h * 2) > (block_length - 12))
+					throw PaperPup::RuntimeError("TIM block out of range");
+
+				// Return block data and skip to next block
+				char *block_data = datap + 12;
+				datap += block_length;
+				return block_data;
+			};
+
+			// Read CLUT
+			char *clut_data = nullptr;
+			size_t clut_length = 0;
+			if (flags & Flags::HasCLUT)
+			{
+				uint16_t clut_x, clut_y, clut_w, clut_h;
+				clut_data = ReadBlock(&clut_x, &clut_y, &clut_w, &clut_h);
+				if (clut >= clut_h)
+					throw PaperPup::RuntimeError("TIM CLUT index out of range");
+				clut_data += (size_t)clut * clut_w * 2;
+				clut_length = clut_w;
+			}
+			if ((mode == Mode::Mode4 || mode == Mode::Mode8) && clut_length < (mode == Mode::Mode4 ? 16U : 256U))
+				throw PaperPup::RuntimeError("TIM indexed image without CLUT");
+
+			// Read image
+			Image image;
+			uint16_t image_x, image_y, image_w, image_h;
+			char *image_data = ReadBlock(&image_x, &image_y, &image_w, &image_h);
+
+			image.x = image_x;
+			image.y = image_y;
+			image.height = image_h;
+			switch (mode)
+			{
+				case Mode::Mode4:
+					image.width = image_w * 4;
+					break;
+				case Mode::Mode8:
+					image.width = image_w * 2;
+					break;
+				case Mode::Mode16:
+					image.width = image_w;
+					break;
+				case Mode::Mode24:
+					image.width = image_w * 2 / 3;
+					break;
+			}
+
+			// Decode pixels
+			image.data.resize((size_t)image.width * image.height);
+			uint16_t *outp = image.data.data();
+
+			for (unsigned int i = 0; i < image.height; i++)
+			{
+				unsigned char *rowp = (unsigned char*)image_data + (size_t)i * image_w * 2;
+				switch (mode)
+				{
+					case Mode::Mode4:
+						for (unsigned int j = 0; j < image.width; j += 2, rowp++)
+						{
+							*outp++ = Filesystem::Read16(clut_data + ((*rowp >> 0) & 0xF) * 2);
+							*outp++ = Filesystem::Read16(clut_data + ((*rowp >> 4) & 0xF) * 2);
+						}
+						break;
+					case Mode::Mode8:
+						for (unsigned int j = 0; j < image.width; j++, rowp++)
+							*outp++ = Filesystem::Read16(clut_data + *rowp * 2);
+						break;
+					case Mode::Mode16:
+						for (unsigned int j = 0; j < image.width; j++, rowp += 2)
+							*outp++ = Filesystem::Read16((char*)rowp);
+						break;
+					case Mode::Mode24:
+						for (unsigned int j = 0; j < image.width; j++, rowp += 3)
+							*outp++ = (uint16_t)((rowp[0] >> 3) << 0) | (uint16_t)((rowp[1] >> 3) << 5) | (uint16_t)((rowp[2] >> 3) << 10);
+						break;
+				}
+			}
+
+			return image;
+		}
+	}
+}
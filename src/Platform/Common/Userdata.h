@@ -14,6 +14,7 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <mutex>
 
 #include "Platform/Filesystem.h"
 
@@ -25,20 +26,23 @@ namespace PaperPup
 		class Userdata
 		{
 			private:
-				// Userdata
+				// Userdata, locked as packs are loaded from worker threads
 				std::unordered_map<std::string, std::string> userdata;
+				std::mutex mutex;
 
 			public:
 				// Userdata interface
 				void Set(std::string key, std::string value)
 				{
 					// Set userdata value
+					std::lock_guard<std::mutex> lock(mutex);
 					if (key.size() != 0 && key.back() != '/')
 						userdata[key] = value;
 				}
 
 				std::string Get(std::string key)
 				{
+					std::lock_guard<std::mutex> lock(mutex);
 					if (key.size() != 0 && key.back() != '/')
 						return userdata[key];
 					return "";
@@ -46,6 +50,7 @@ namespace PaperPup
 
 				bool Exists(std::string key)
 				{
+					std::lock_guard<std::mutex> lock(mutex);
 					if (key.size() != 0 && key.back() != '/')
 						return userdata.find(key) != userdata.end();
 					return false;
@@ -53,6 +58,7 @@ namespace PaperPup
 
 				void Clear(std::string key)
 				{
+					std::lock_guard<std::mutex> lock(mutex);
 					if (key.size() == 0)
 					{
 						// Clear userdata
@@ -79,6 +85,7 @@ namespace PaperPup
 				std::vector<char> Serialize()
 				{
 					// Write userdata values to buffer
+					std::lock_guard<std::mutex> lock(mutex);
 					std::vector<char> userdata_data;
 					for (auto &i : userdata)
 					{
@@ -99,6 +106,7 @@ namespace PaperPup
 				void Deserialize(std::vector<char> &data)
 				{
 					// Deserialize data
+					std::lock_guard<std::mutex> lock(mutex);
 					char *userdatap = data.data();
 					char *userdata_end = userdatap + data.size();
 
@@ -115,7 +123,8 @@ namespace PaperPup
 						// Set userdata
 						std::string key(userdatap + 8, key_length);
 						std::string value(userdatap + 8 + key_length, value_length);
-						Set(key, value);
+						if (key.size() != 0 && key.back() != '/')
+							userdata[key] = value;
 
 						// Read next userdata
 						userdatap = userdata_next;
@@ -14,18 +14,23 @@
 #include "Platform/Platform.h"
 
 #include <memory>
+#include <cstring>
 
 namespace PaperPup
 {
+	namespace Audio { template <class T> class Sound; }
+	namespace CDDA { class Track; }
+
 	namespace Filesystem
 	{
 		// Image helpers
-		static uint16_t Read16(char *data) { return (((uint16_t)((uint8_t)data[0])) << 0) | (((uint16_t)((uint8_t)data[1])) << 8); }
-		static uint32_t Read32(char *data) { return (((uint32_t)((uint8_t)data[0])) << 0) | (((uint32_t)((uint8_t)data[1])) << 8) | (((uint32_t)((uint8_t)data[2])) << 16) | (((uint32_t)((uint8_t)data[3])) << 24); }
+		static uint16_t Read16(const char *data) { return (((uint16_t)((uint8_t)data[0])) << 0) | (((uint16_t)((uint8_t)data[1])) << 8); }
+		static uint32_t Read32(const char *data) { return (((uint32_t)((uint8_t)data[0])) << 0) | (((uint32_t)((uint8_t)data[1])) << 8) | (((uint32_t)((uint8_t)data[2])) << 16) | (((uint32_t)((uint8_t)data[3])) << 24); }
 
 		// Image class
 		class Archive;
 		class File;
+		class Mem;
 
 		class Image
 		{
@@ -36,6 +41,10 @@ namespace PaperPup
 
 				virtual Archive *OpenArchive(std::string name) = 0;
 				virtual File *OpenFile(std::string name, bool mode2 = false) = 0;
+				virtual File *OpenFileRange(std::string name, size_t offset, size_t length) = 0; // Reads only part of a file, clamped to its end
+				virtual File *OpenBytecode(std::string name) = 0;
+				virtual File *OpenTexture(std::string name) = 0; // Pre-decoded TIM, see TIM::Serialize
+				virtual Audio::Sound<CDDA::Track> *OpenTrack(unsigned int number) = 0; // Has its own backend, so Play and Stop lock the audio thread
 		};
 
 		// Archive class
@@ -46,6 +55,7 @@ namespace PaperPup
 				virtual ~Archive() {}
 
 				virtual File *OpenFile(std::string name) = 0;
+				virtual Mem *OpenMem(std::string name, uint32_t base) = 0;
 		};
 		
 		// File class
@@ -53,12 +63,15 @@ namespace PaperPup
 		{
 			private:
 				// Data
-				std::unique_ptr<char[]> data;
+				std::unique_ptr<char[]> data_owned;
+				std::shared_ptr<const void> data_hold;
+				const char *data;
 				size_t cursor = 0, size;
 
 			public:
 				// File interface
-				File(char *_data, size_t _size) : data(_data), size(_size) {}
+				File(char *_data, size_t _size) : data_owned(_data), data(_data), size(_size) {}
+				File(const char *_data, size_t _size, std::shared_ptr<const void> _hold) : data_hold(_hold), data(_data), size(_size) {} // Borrows memory kept alive by hold
 				~File() {}
 
 				size_t Size() const
@@ -66,6 +79,16 @@ namespace PaperPup
 					return size;
 				}
 
+				const char *Data() const
+				{
+					return data;
+				}
+
+				std::shared_ptr<const void> Hold() const
+				{
+					return data_hold;
+				}
+
 				bool Seek(size_t pos)
 				{
 					if (pos > size)
@@ -90,7 +113,7 @@ namespace PaperPup
 					}
 
 					// Copy to buffer
-					std::memcpy(buffer, data.get() + cursor, length);
+					std::memcpy(buffer, data + cursor, length);
 					cursor += length;
 					return length;
 				}
@@ -99,12 +122,161 @@ namespace PaperPup
 				{
 					// Create new buffer with file contents
 					char *dup = new char[size];
-					std::memcpy(dup, data.get(), size);
+					std::memcpy(dup, data, size);
 					return dup;
 				}
+
+				char *Release()
+				{
+					// Give up our buffer, borrowed contents have to be copied
+					char *released = (data_owned != nullptr) ? data_owned.release() : Dup();
+					data = nullptr;
+					cursor = size = 0;
+					return released;
+				}
 		};
 
+		// Mem class
+		static constexpr uint32_t MEM_ADDRESS_MASK = 0x1FFFFFFF; // Strips the KUSEG/KSEG0/KSEG1 segment bits
+
+		class MemView;
+
+		class Mem
+		{
+			private:
+				// Data
+				std::unique_ptr<char[]> data;
+				size_t size;
+
+				// Address the blob was linked to be loaded at
+				uint32_t base;
+
+			public:
+				// Mem interface
+				Mem(char *_data, size_t _size, uint32_t _base) : data(_data), size(_size), base(_base & MEM_ADDRESS_MASK) {}
+				~Mem() {}
+
+				size_t Size() const
+				{
+					return size;
+				}
+
+				uint32_t Base() const
+				{
+					return base;
+				}
+
+				const char *Data() const
+				{
+					return data.get();
+				}
+
+				bool Contains(size_t offset, size_t length) const
+				{
+					return length <= size && offset <= (size - length);
+				}
+
+				uint8_t Read8(size_t offset) const
+				{
+					Check(offset, 1);
+					return (uint8_t)data[offset];
+				}
+
+				uint16_t Read16(size_t offset) const
+				{
+					Check(offset, 2);
+					return Filesystem::Read16(data.get() + offset);
+				}
+
+				uint32_t Read32(size_t offset) const
+				{
+					Check(offset, 4);
+					return Filesystem::Read32(data.get() + offset);
+				}
+
+				int16_t ReadS16(size_t offset) const
+				{
+					return (int16_t)Read16(offset);
+				}
+
+				int32_t ReadS32(size_t offset) const
+				{
+					return (int32_t)Read32(offset);
+				}
+
+				size_t Resolve(uint32_t address) const
+				{
+					// Relocate address into an offset in our blob
+					size_t offset = (size_t)((address & MEM_ADDRESS_MASK) - base);
+					if ((address & MEM_ADDRESS_MASK) < base || offset >= size)
+						throw PaperPup::RuntimeError("Mem pointer out of range");
+					return offset;
+				}
+
+				MemView View(size_t offset) const;
+				MemView Pointer(size_t offset) const;
+
+			private:
+				void Check(size_t offset, size_t length) const
+				{
+					if (!Contains(offset, length))
+						throw PaperPup::RuntimeError("Mem read out of range");
+				}
+		};
+
+		class MemView
+		{
+			private:
+				// Viewed blob and offset
+				const Mem *mem = nullptr;
+				size_t offset = 0;
+
+			public:
+				// Mem view interface
+				MemView() {}
+				MemView(const Mem *_mem, size_t _offset) : mem(_mem), offset(_offset) {}
+
+				size_t Offset() const { return offset; }
+
+				uint8_t Read8(size_t at) const { return mem->Read8(offset + at); }
+				uint16_t Read16(size_t at) const { return mem->Read16(offset + at); }
+				uint32_t Read32(size_t at) const { return mem->Read32(offset + at); }
+				int16_t ReadS16(size_t at) const { return mem->ReadS16(offset + at); }
+				int32_t ReadS32(size_t at) const { return mem->ReadS32(offset + at); }
+
+				MemView View(size_t at) const { return mem->View(offset + at); }
+				MemView Pointer(size_t at) const { return mem->Pointer(offset + at); }
+
+				explicit operator bool() const
+				{
+					return mem != nullptr;
+				}
+		};
+
+		inline MemView Mem::View(size_t offset) const
+		{
+			Check(offset, 0);
+			return MemView(this, offset);
+		}
+
+		inline MemView Mem::Pointer(size_t offset) const
+		{
+			// Null pointers give an empty view
+			uint32_t address = Read32(offset);
+			if (address == 0)
+				return MemView();
+			return MemView(this, Resolve(address));
+		}
+
 		// Filesystem functions
 		std::vector<std::string> GetPackList();
+		uint64_t ImageStamp(std::string name, uint64_t *size = nullptr);
+		uint64_t ImageStat(std::string name);
+
+		bool ReadLocal(std::string name, std::vector<char> &data);
+		void WriteLocal(std::string name, const std::vector<char> &data);
+
+		bool LocalTime(std::string name, uint64_t &time);
+		bool SetLocalTime(std::string name, uint64_t time);
 	}
 }
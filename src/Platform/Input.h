@@ -17,7 +17,23 @@ namespace PaperPup
 {
 	namespace Input
 	{
+		// Input buttons
+		enum class Button
+		{
+			Up,
+			Down,
+			Left,
+			Right,
+			Confirm,
+			Back,
+			Count
+		};
+
 		// Input interface
 		bool HandleEvents();
+
+		// Button state, pressed is only set on the frame the button went down
+		bool ButtonHeld(Button button);
+		bool ButtonPressed(Button button);
 	}
 }
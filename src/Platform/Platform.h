@@ -46,6 +46,10 @@ namespace PaperPup
 	// Application facing entry point
 	int Main(std::vector<std::string> args);
 
+	// Error display
+	void DisplayError(std::string _error);
+	void LogError(std::string _error);
+
 	// Exception types
 	class RuntimeError : public std::runtime_error
 	{
@@ -14,6 +14,10 @@
 #include "Platform/Common/Mode2.h"
 #include "Platform/Common/Binary.h"
 #include "Platform/Common/IntArchive.h"
+#include "Platform/Common/Bundle.h"
+#include "Platform/Common/Cue.h"
+#include "Platform/Common/CDDA.h"
+#include "Platform/Common/Hash.h"
 
 #include <algorithm>
 #include <functional>
@@ -78,12 +82,13 @@ namespace PaperPup
 		class Binary_Impl : public Binary
 		{
 			private:
-				// Binary handle
+				// Binary handle and track start
 				HANDLE handle_bin;
+				uint32_t lba_base;
 
 			public:
 				// Binary interface
-				Binary_Impl(HANDLE _handle_bin): handle_bin(_handle_bin)
+				Binary_Impl(HANDLE _handle_bin, uint32_t _lba_base = 0): handle_bin(_handle_bin), lba_base(_lba_base)
 				{
 					// Parse binary directory
 					ParseDirectory();
@@ -99,8 +104,9 @@ namespace PaperPup
 				void SeekLBA(uint32_t lba) override
 				{
 					// Seek to LBA in file
-					DWORD result = SetFilePointer(handle_bin, lba * SECTOR_MODE2, nullptr, FILE_BEGIN);
-					if (result == INVALID_SET_FILE_POINTER && GetLastError() != NO_ERROR)
+					LARGE_INTEGER position;
+					position.QuadPart = (LONGLONG)(lba_base + lba) * SECTOR_MODE2;
+					if (SetFilePointerEx(handle_bin, position, nullptr, FILE_BEGIN) == FALSE)
 						throw PaperPup::RuntimeError("Binary seek failed");
 				}
 
@@ -124,6 +130,44 @@ namespace PaperPup
 				}
 		};
 
+		class CDDA_Reader_Impl : public CDDA::Reader
+		{
+			private:
+				// Track handle and sectors
+				HANDLE handle_bin;
+				uint32_t lba_start, lba_count;
+
+			public:
+				// CDDA reader interface
+				CDDA_Reader_Impl(HANDLE _handle_bin, uint32_t _lba_start, uint32_t _lba_count) : handle_bin(_handle_bin), lba_start(_lba_start), lba_count(_lba_count) {}
+
+				~CDDA_Reader_Impl() override
+				{
+					// Close track file
+					CloseHandle(handle_bin);
+				}
+
+				// CDDA reader implementation
+				uint32_t Sectors() override
+				{
+					return lba_count;
+				}
+
+				bool ReadSectors(uint32_t lba, uint32_t count, char *data) override
+				{
+					// Seek to LBA in file
+					LARGE_INTEGER position;
+					position.QuadPart = (LONGLONG)(lba_start + lba) * SECTOR_MODE2;
+					if (SetFilePointerEx(handle_bin, position, nullptr, FILE_BEGIN) == FALSE)
+						return false;
+
+					// Read sectors from file
+					DWORD request = SECTOR_MODE2 * count;
+					DWORD result;
+					return ReadFile(handle_bin, data, request, &result, nullptr) != FALSE && result == request;
+				}
+		};
+
 		class Archive_Impl : public Archive
 		{
 			private:
@@ -184,15 +228,31 @@ namespace PaperPup
 
 					return nullptr;
 				}
+
+				Mem *OpenMem(std::string name, uint32_t base) override
+				{
+					// Open as a file, the blob adopts its buffer
+					std::unique_ptr<File> file(OpenFile(name));
+					if (file == nullptr)
+						return nullptr;
+
+					size_t size = file->Size();
+					return new Mem(file->Release(), size, base);
+				}
 		};
 
 		class Image_Impl : public Image
 		{
 			public:
-				// Image path and binary
+				// Image path, bundle, and binary
 				std::wstring path_image;
+				std::unique_ptr<Bundle> bundle;
 				std::unique_ptr<Binary_Impl> binary;
 
+				// Cue sheet tracks, and the folder their files are relative to
+				std::vector<Cue_Track> tracks;
+				std::wstring path_tracks;
+
 			public:
 				// Image interface
 				Image_Impl(std::string name)
@@ -202,10 +262,37 @@ namespace PaperPup
 					std::wstring path_bin = g_impl->filesystem->module_path + path_name + L".bin";
 					path_image = g_impl->filesystem->module_path + path_name + L"\\";
 
+					// Map bundle file
+					std::wstring path_bundle = g_impl->filesystem->module_path + path_name + L".bundle";
+					bundle.reset(MapBundle(path_bundle));
+
+					// Read cue sheet
+					uint32_t lba_base = 0;
+
+					std::vector<char> cue;
+					if (ReadLocal(name + ".cue", cue))
+					{
+						tracks = ParseCue(std::string(cue.data(), cue.size()));
+
+						size_t path_end = path_bin.find_last_of(L"/\\");
+						path_tracks = path_bin.substr(0, path_end + 1);
+
+						// Use the first mode 2 track as our data track
+						for (auto &track : tracks)
+						{
+							if (track.mode2)
+							{
+								path_bin = path_tracks + Win32::UTF8ToWide(track.file);
+								lba_base = track.start;
+								break;
+							}
+						}
+					}
+
 					// Open binary file
 					HANDLE handle_bin = CreateFileW(path_bin.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
 					if (handle_bin != INVALID_HANDLE_VALUE)
-						binary = std::make_unique<Binary_Impl>(handle_bin);
+						binary = std::make_unique<Binary_Impl>(handle_bin, lba_base);
 				}
 
 				~Image_Impl() override
@@ -251,6 +338,14 @@ namespace PaperPup
 						return new File(data.release(), file_size);
 					}
 
+					// Try to open from bundle
+					if (bundle != nullptr)
+					{
+						File *file;
+						if ((file = bundle->OpenFile(name, mode2 ? BUNDLE_TYPE_MODE2 : BUNDLE_TYPE_DATA)) != nullptr)
+							return file;
+					}
+
 					// Try to open file binary
 					if (binary != nullptr)
 					{
@@ -262,6 +357,158 @@ namespace PaperPup
 					// Failed to open file
 					return nullptr;
 				}
+
+				File *OpenFileRange(std::string name, size_t offset, size_t length) override
+				{
+					// Try to open from folder
+					std::wstring path_file = path_image + Win32::UTF8ToWide(name);
+					std::replace(path_file.begin(), path_file.end(), '/', '\\');
+
+					HANDLE handle_file = CreateFileW(path_file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+					if (handle_file != INVALID_HANDLE_VALUE)
+					{
+						// Clamp range to file
+						LARGE_INTEGER file_size;
+						if (GetFileSizeEx(handle_file, &file_size) == FALSE || (ULONGLONG)offset > (ULONGLONG)file_size.QuadPart)
+						{
+							CloseHandle(handle_file);
+							return nullptr;
+						}
+						length = (size_t)std::min<ULONGLONG>(length, (ULONGLONG)file_size.QuadPart - offset);
+
+						// Read range
+						LARGE_INTEGER position;
+						position.QuadPart = (LONGLONG)offset;
+						std::unique_ptr<char[]> data = std::make_unique<char[]>(length);
+
+						DWORD result = 0;
+						BOOL read_result = SetFilePointerEx(handle_file, position, nullptr, FILE_BEGIN) && ReadFile(handle_file, data.get(), (DWORD)length, &result, nullptr);
+						CloseHandle(handle_file);
+
+						if (read_result == FALSE || result != length)
+							return nullptr;
+						return new File(data.release(), length);
+					}
+
+					// Try to open from bundle, borrowing only the range
+					if (bundle != nullptr)
+					{
+						std::unique_ptr<File> file(bundle->OpenFile(name, BUNDLE_TYPE_DATA));
+						if (file != nullptr)
+						{
+							if (offset > file->Size())
+								return nullptr;
+							return new File(file->Data() + offset, std::min<size_t>(length, file->Size() - offset), file->Hold());
+						}
+					}
+
+					// Try to open file binary
+					if (binary != nullptr)
+						return binary->OpenFileRange(name, offset, length);
+
+					// Failed to open file
+					return nullptr;
+				}
+
+				File *OpenBytecode(std::string name) override
+				{
+					// Loose source files take priority over anything precompiled
+					std::wstring path_file = path_image + Win32::UTF8ToWide(name);
+					std::replace(path_file.begin(), path_file.end(), '/', '\\');
+					if (FileExists(path_file))
+						return nullptr;
+
+					// Try to open from bundle
+					if (bundle != nullptr)
+						return bundle->OpenFile(name, BUNDLE_TYPE_BYTECODE);
+					return nullptr;
+				}
+
+				File *OpenTexture(std::string name) override
+				{
+					// Loose files take priority over anything pre-decoded
+					std::wstring path_file = path_image + Win32::UTF8ToWide(name);
+					std::replace(path_file.begin(), path_file.end(), '/', '\\');
+					if (FileExists(path_file))
+						return nullptr;
+
+					// Try to open from bundle
+					if (bundle != nullptr)
+						return bundle->OpenFile(name, BUNDLE_TYPE_TEXTURE);
+					return nullptr;
+				}
+
+				Audio::Sound<CDDA::Track> *OpenTrack(unsigned int number) override
+				{
+					// Find audio track
+					for (auto &track : tracks)
+					{
+						if (track.number != number || !track.audio)
+							continue;
+
+						// Open a handle for the streaming thread to read from
+						std::wstring path_track = path_tracks + Win32::UTF8ToWide(track.file);
+						HANDLE handle_track = CreateFileW(path_track.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+						if (handle_track == INVALID_HANDLE_VALUE)
+							return nullptr;
+
+						// Tracks without an end run to the end of their file
+						uint32_t lba_end = track.end;
+						if (lba_end == 0)
+						{
+							LARGE_INTEGER track_size;
+							if (GetFileSizeEx(handle_track, &track_size) == FALSE)
+							{
+								CloseHandle(handle_track);
+								return nullptr;
+							}
+							lba_end = (uint32_t)(track_size.QuadPart / SECTOR_MODE2);
+						}
+
+						return Audio::Sound<CDDA::Track>::New(new CDDA_Reader_Impl(handle_track, track.start, (lba_end > track.start) ? (lba_end - track.start) : 0));
+					}
+					return nullptr;
+				}
+
+			private:
+				static Bundle *MapBundle(std::wstring path_bundle)
+				{
+					// Open bundle file
+					HANDLE handle_bundle = CreateFileW(path_bundle.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+					if (handle_bundle == INVALID_HANDLE_VALUE)
+						return nullptr;
+
+					LARGE_INTEGER bundle_size;
+					if (GetFileSizeEx(handle_bundle, &bundle_size) == FALSE || bundle_size.QuadPart == 0)
+					{
+						CloseHandle(handle_bundle);
+						return nullptr;
+					}
+
+					// Map bundle into memory
+					HANDLE handle_mapping = CreateFileMappingW(handle_bundle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+					CloseHandle(handle_bundle);
+					if (handle_mapping == nullptr)
+						return nullptr;
+
+					const void *view = MapViewOfFile(handle_mapping, FILE_MAP_READ, 0, 0, 0);
+					CloseHandle(handle_mapping);
+					if (view == nullptr)
+						return nullptr;
+
+					// Files opened from the bundle keep the view alive
+					// Bundles from another version are ignored rather than failing the image, the binary still works
+					std::shared_ptr<const void> hold(view, [](const void *view) { UnmapViewOfFile(view); });
+					try
+					{
+						return new Bundle((const char*)view, (size_t)bundle_size.QuadPart, hold);
+					}
+					catch (PaperPup::RuntimeError &exception)
+					{
+						(void)exception;
+						return nullptr;
+					}
+				}
 		};
 
 		Image *Image::Open(std::string name)
@@ -308,5 +555,198 @@ namespace PaperPup
 			});
 			return packs;
 		}
+
+		uint64_t ImageStamp(std::string name, uint64_t *size)
+		{
+			// Stamp every file making up the image by name, size, and modification time, only the cue sheet is read
+			std::wstring path_name = g_impl->filesystem->module_path + Win32::UTF8ToWide(name);
+			std::replace(path_name.begin(), path_name.end(), '/', '\\');
+
+			size_t path_end = path_name.find_last_of(L'\\');
+			std::wstring path_folder = path_name.substr(0, path_end + 1);
+
+			uint64_t stamp = 0, stamp_size = 0;
+			std::vector<std::wstring> stamped;
+			auto StampFile = [&](std::wstring file_path, uint64_t file_size, FILETIME file_time)
+			{
+				// Files are found in no particular order, so sum their hashes
+				std::wstring file_key = file_path;
+				std::transform(file_key.begin(), file_key.end(), file_key.begin(), [](wchar_t c) { return (wchar_t)towlower(c); });
+				if (std::find(stamped.begin(), stamped.end(), file_key) != stamped.end())
+					return;
+				stamped.push_back(file_key);
+
+				uint64_t hash = Hash::FNV1a(file_key.data(), file_key.size() * sizeof(wchar_t));
+				hash = Hash::FNV1a((uint32_t)file_size, hash);
+				hash = Hash::FNV1a((uint32_t)(file_size >> 32), hash);
+				hash = Hash::FNV1a((uint32_t)file_time.dwLowDateTime, hash);
+				hash = Hash::FNV1a((uint32_t)file_time.dwHighDateTime, hash);
+				stamp += hash;
+				stamp_size += file_size;
+			};
+
+			std::function<void(std::wstring)> StampFolder = [&](std::wstring pattern)
+			{
+				size_t pattern_end = pattern.find_last_of(L'\\');
+				std::wstring pattern_folder = pattern.substr(0, pattern_end + 1);
+
+				DirectoryIterate(pattern, [&](WIN32_FIND_DATAW &file_data)
+				{
+					std::wstring file_name = file_data.cFileName;
+					if (file_name == L"." || file_name == L"..")
+						return;
+
+					// Image folders hold loose files, so look inside them too
+					if (file_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+					{
+						StampFolder(pattern_folder + file_name + L"\\*");
+						return;
+					}
+
+					StampFile(pattern_folder.substr(path_folder.size()) + file_name, ((uint64_t)file_data.nFileSizeHigh << 32) | file_data.nFileSizeLow, file_data.ftLastWriteTime);
+				});
+			};
+
+			// Covers the image folder, binary, bundle, and cue sheet
+			StampFolder(path_name + L"*");
+
+			// Cue sheet track files can be named anything, and are opened relative to the binary's folder
+			std::vector<char> cue;
+			if (ReadLocal(name + ".cue", cue))
+			{
+				std::vector<Cue_Track> tracks;
+				try
+				{
+					tracks = ParseCue(std::string(cue.data(), cue.size()));
+				}
+				catch (PaperPup::RuntimeError&)
+				{
+					// The image fails to open anyway, the cue sheet's own stamp is enough
+				}
+
+				for (auto &track : tracks)
+				{
+					// Missing track files still stamp their name, so adding them later changes the stamp
+					std::wstring track_path = Win32::UTF8ToWide(track.file);
+					std::replace(track_path.begin(), track_path.end(), '/', '\\');
+
+					WIN32_FILE_ATTRIBUTE_DATA track_data = {};
+					if (!GetFileAttributesExW((path_folder + track_path).c_str(), GetFileExInfoStandard, &track_data))
+						track_data = {};
+					StampFile(track_path, ((uint64_t)track_data.nFileSizeHigh << 32) | track_data.nFileSizeLow, track_data.ftLastWriteTime);
+				}
+			}
+
+			if (size != nullptr)
+				*size = stamp_size;
+			return stamp;
+		}
+
+		uint64_t ImageStat(std::string name)
+		{
+			// Stat the image's binary, cue sheet, bundle, and folder by size and modification time, without listing or reading anything
+			std::wstring path_name = g_impl->filesystem->module_path + Win32::UTF8ToWide(name);
+			std::replace(path_name.begin(), path_name.end(), '/', '\\');
+
+			uint64_t stat = Hash::FNV_OFFSET;
+			for (const wchar_t *suffix : { L".bin", L".cue", L".bundle", L"" })
+			{
+				// Missing files stat as zero, so adding one changes the result
+				WIN32_FILE_ATTRIBUTE_DATA file_data = {};
+				if (!GetFileAttributesExW((path_name + suffix).c_str(), GetFileExInfoStandard, &file_data))
+					file_data = {};
+				stat = Hash::FNV1a((uint32_t)file_data.nFileSizeLow, stat);
+				stat = Hash::FNV1a((uint32_t)file_data.nFileSizeHigh, stat);
+				stat = Hash::FNV1a((uint32_t)file_data.ftLastWriteTime.dwLowDateTime, stat);
+				stat = Hash::FNV1a((uint32_t)file_data.ftLastWriteTime.dwHighDateTime, stat);
+			}
+			return stat;
+		}
+
+		bool ReadLocal(std::string name, std::vector<char> &data)
+		{
+			// Open local file
+			std::wstring path_file = g_impl->filesystem->module_path + Win32::UTF8ToWide(name);
+			std::replace(path_file.begin(), path_file.end(), '/', '\\');
+
+			HANDLE handle_file = CreateFileW(path_file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+			if (handle_file == INVALID_HANDLE_VALUE)
+				return false;
+
+			// Read file contents
+			DWORD file_size = GetFileSize(handle_file, nullptr);
+			data.resize((size_t)file_size);
+
+			DWORD result;
+			BOOL read_result = ReadFile(handle_file, data.data(), file_size, &result, nullptr);
+			CloseHandle(handle_file);
+
+			return read_result != FALSE && result == file_size;
+		}
+
+		void WriteLocal(std::string name, const std::vector<char> &data)
+		{
+			// Create parent folders
+			std::wstring path_file = g_impl->filesystem->module_path + Win32::UTF8ToWide(name);
+			std::replace(path_file.begin(), path_file.end(), '/', '\\');
+
+			for (size_t i = g_impl->filesystem->module_path.size(); (i = path_file.find(L'\\', i)) != std::wstring::npos; i++)
+			{
+				std::wstring path_folder = path_file.substr(0, i);
+				if (!DirectoryExists(path_folder))
+					CreateDirectoryW(path_folder.c_str(), nullptr);
+			}
+
+			// Write to a temporary file then swap it in, so readers never see a partial file
+			std::wstring path_temp = path_file + L".tmp";
+
+			HANDLE handle_file = CreateFileW(path_temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, 0, nullptr);
+			if (handle_file == INVALID_HANDLE_VALUE)
+				return;
+
+			DWORD result;
+			BOOL write_result = WriteFile(handle_file, data.data(), (DWORD)data.size(), &result, nullptr);
+			CloseHandle(handle_file);
+
+			if (write_result == FALSE || result != data.size())
+			{
+				DeleteFileW(path_temp.c_str());
+				return;
+			}
+			MoveFileExW(path_temp.c_str(), path_file.c_str(), MOVEFILE_REPLACE_EXISTING);
+		}
+
+		bool LocalTime(std::string name, uint64_t &time)
+		{
+			// Get local file or folder modification time
+			std::wstring path_file = g_impl->filesystem->module_path + Win32::UTF8ToWide(name);
+			std::replace(path_file.begin(), path_file.end(), '/', '\\');
+
+			WIN32_FILE_ATTRIBUTE_DATA file_attributes;
+			if (GetFileAttributesExW(path_file.c_str(), GetFileExInfoStandard, &file_attributes) == FALSE)
+				return false;
+
+			time = ((uint64_t)file_attributes.ftLastWriteTime.dwHighDateTime << 32) | file_attributes.ftLastWriteTime.dwLowDateTime;
+			return true;
+		}
+
+		bool SetLocalTime(std::string name, uint64_t time)
+		{
+			// Set local file modification time, this doesn't touch the time of its folder
+			std::wstring path_file = g_impl->filesystem->module_path + Win32::UTF8ToWide(name);
+			std::replace(path_file.begin(), path_file.end(), '/', '\\');
+
+			HANDLE handle_file = CreateFileW(path_file.c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+			if (handle_file == INVALID_HANDLE_VALUE)
+				return false;
+
+			FILETIME file_time;
+			file_time.dwLowDateTime = (DWORD)(time >> 0);
+			file_time.dwHighDateTime = (DWORD)(time >> 32);
+			BOOL result = SetFileTime(handle_file, nullptr, nullptr, &file_time);
+			CloseHandle(handle_file);
+
+			return result != FALSE;
+		}
 	}
-}
\ No newline at end of file
+}
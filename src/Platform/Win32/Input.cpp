@@ -47,15 +47,64 @@ namespace PaperPup
 					g_impl->render->Resize();
 					break;
 				}
+
+				case WM_KEYDOWN:
+				case WM_KEYUP:
+				{
+					// Update button state, key repeats don't press again
+					Button button;
+					if (g_impl->input != nullptr && KeyButton(wparam, button))
+					{
+						bool down = (message == WM_KEYDOWN);
+						if (down && !(lparam & (1 << 30)))
+							g_impl->input->button_pressed[(size_t)button] = true;
+						g_impl->input->button_held[(size_t)button] = down;
+						return 0;
+					}
+					break;
+				}
 			}
 
 			// Handle default process
 			return DefWindowProc(parent, message, wparam, lparam);
 		}
 
+		bool Impl::KeyButton(WPARAM key, Button &button)
+		{
+			// Map keyboard keys to buttons
+			switch (key)
+			{
+				case VK_UP:
+					button = Button::Up;
+					return true;
+				case VK_DOWN:
+					button = Button::Down;
+					return true;
+				case VK_LEFT:
+					button = Button::Left;
+					return true;
+				case VK_RIGHT:
+					button = Button::Right;
+					return true;
+				case VK_RETURN:
+				case 'Z':
+					button = Button::Confirm;
+					return true;
+				case VK_ESCAPE:
+				case 'X':
+					button = Button::Back;
+					return true;
+			}
+			return false;
+		}
+
 		// Input interface
 		bool HandleEvents()
 		{
+			// Presses only last one frame
+			for (bool &pressed : g_impl->input->button_pressed)
+				pressed = false;
+
 			// Process window messages
 			MSG window_msg = {};
 			while (PeekMessageW(&window_msg, nullptr, 0, 0, PM_REMOVE))
@@ -67,5 +116,15 @@ namespace PaperPup
 			}
 			return false;
 		}
+
+		bool ButtonHeld(Button button)
+		{
+			return g_impl->input->button_held[(size_t)button];
+		}
+
+		bool ButtonPressed(Button button)
+		{
+			return g_impl->input->button_pressed[(size_t)button];
+		}
 	}
 }
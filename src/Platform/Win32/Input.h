@@ -23,7 +23,9 @@ namespace PaperPup
 		class Impl
 		{
 			public:
-			
+				// Button state
+				bool button_held[(size_t)Button::Count] = {};
+				bool button_pressed[(size_t)Button::Count] = {};
 
 			public:
 				// Win32 implementation interface
@@ -31,6 +33,8 @@ namespace PaperPup
 				~Impl();
 
 				static LRESULT WindowProc(HWND parent, UINT message, WPARAM wparam, LPARAM lparam);
+
+				static bool KeyButton(WPARAM key, Button &button);
 		};
 	}
 }
@@ -56,6 +56,12 @@ namespace PaperPup
 				window = g_impl->render->window;
 		MessageBoxW(window, (L"PaperPup Runtime Error:\n" + Win32::UTF8ToWide(_error)).c_str(), L"PaperPup", MB_ICONERROR);
 	}
+
+	void LogError(std::string _error)
+	{
+		// Write error to the debugger output without blocking
+		OutputDebugStringW((L"PaperPup Error: " + Win32::UTF8ToWide(_error) + L"\n").c_str());
+	}
 }
 
 // Program entry point
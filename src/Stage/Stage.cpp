@@ -0,0 +1,184 @@
+/*
+ * [PaperPup]
+ *   Stage.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "Stage/Stage.h"
+
+#include "Menu/Menu.h"
+
+#include "Platform/Input.h"
+
+namespace PaperPup
+{
+	namespace Stage
+	{
+		// Stage helpers
+		static const Asset *CommandAsset(AssetLoader *assets, double position)
+		{
+			// Positions count from 1, like the Assets list they index
+			if (!(position >= 1.0 && position <= (double)assets->Total()))
+				return nullptr;
+			return assets->At((size_t)position - 1);
+		}
+
+		static Audio::Sound<CDDA::Track> *CommandTrack(AssetLoader *assets, double number)
+		{
+			if (!(number >= 1.0 && number <= 99.0))
+				return nullptr;
+			return assets->Track((unsigned int)number);
+		}
+
+		// Stage class interface
+		Stage::Stage(std::unique_ptr<Pack> _pack, size_t _song_index) : pack(std::move(_pack)), song_index(_song_index)
+		{
+
+		}
+
+		Stage::~Stage()
+		{
+			// Stop the song's scripts before its pack goes
+			lua.reset();
+		}
+
+		State *Stage::Start()
+		{
+			// Start loading the song's assets
+			AssetLoader *assets;
+			try
+			{
+				assets = pack->PreloadSong(song_index);
+			}
+			catch (PaperPup::RuntimeError &exception)
+			{
+				LogError(pack->pack_path + ": " + exception.what());
+				return new Menu::Menu();
+			}
+
+			// Upload them within the per-frame budget, the song's scripts only start once they're all in
+			bool loaded = false;
+			while (!loaded)
+			{
+				if (g_engine->StartFrame())
+					return nullptr;
+
+				loaded = assets->Upload();
+				bool stop = Input::ButtonPressed(Input::Button::Back);
+
+				// End frame
+				g_engine->EndFrame();
+
+				if (stop)
+					return new Menu::Menu();
+			}
+
+			try
+			{
+				// Open the song's module on a frame driven controller, so the engine steps its scheduler and collector between frames
+				Song &song = pack->LoadSong(song_index);
+				lua = std::make_unique<Lua::LuaController>(true);
+				lua->SetName(pack->pack_path + "/" + song.song_path + "/SONG.LUA");
+				RegisterOps(assets);
+				lua->RequireImageFile(pack->Image(), song.song_path + "/SONG.LUA");
+
+				// Play the song's audio track, opened with its assets
+				lua_State *state = lua->global_state;
+				lua_getfield(state, -1, "Track");
+				if (lua_isnumber(state, -1))
+				{
+					Audio::Sound<CDDA::Track> *track = CommandTrack(assets, lua_tonumber(state, -1));
+					if (track != nullptr)
+						track->Play();
+				}
+				lua_pop(state, 1);
+
+				// Run the module's Start as a spawned thread, so it can wait on frames and beats
+				lua_getfield(state, -1, "Start");
+				if (lua_isfunction(state, -1))
+				{
+					lua_getfield(state, LUA_GLOBALSINDEX, "spawn");
+					lua_insert(state, -2);
+					Lua::ProtectedCall(state, 1, 0);
+				}
+				else
+				{
+					lua_pop(state, 1);
+				}
+				lua_pop(state, 1);
+			}
+			catch (PaperPup::RuntimeError &exception)
+			{
+				// A broken song goes back to the menu rather than ending the game
+				LogError(pack->pack_path + ": " + exception.what());
+				return new Menu::Menu();
+			}
+
+			while (!g_engine->StartFrame())
+			{
+				// Return to the menu on back or the Exit command, or once the watchdog has stopped the song's scripts
+				bool stop = Input::ButtonPressed(Input::Button::Back) || exit_requested || lua->Killed();
+
+				// End frame
+				g_engine->EndFrame();
+
+				if (stop)
+					return new Menu::Menu();
+			}
+
+			return nullptr;
+		}
+
+		void Stage::RegisterOps(AssetLoader *assets)
+		{
+			// Ops are dispatched at the end of each frame, scripts get their ids with Commands.op
+			Lua::CommandBuffer &commands = lua->Commands();
+
+			// PlaySound(position), StopSound(position), by the sound's position in the Assets list
+			commands.AddOp("PlaySound", [assets](const double *args)
+			{
+				const Asset *asset = CommandAsset(assets, args[0]);
+				if (asset != nullptr && asset->sound != nullptr)
+					asset->sound->Play();
+			});
+			commands.AddOp("StopSound", [assets](const double *args)
+			{
+				const Asset *asset = CommandAsset(assets, args[0]);
+				if (asset != nullptr && asset->sound != nullptr)
+					asset->sound->Stop();
+			});
+
+			// PlayTrack(number), StopTrack(number), LoopTrack(number, loop)
+			commands.AddOp("PlayTrack", [assets](const double *args)
+			{
+				Audio::Sound<CDDA::Track> *track = CommandTrack(assets, args[0]);
+				if (track != nullptr)
+					track->Play();
+			});
+			commands.AddOp("StopTrack", [assets](const double *args)
+			{
+				Audio::Sound<CDDA::Track> *track = CommandTrack(assets, args[0]);
+				if (track != nullptr)
+					track->Stop();
+			});
+			commands.AddOp("LoopTrack", [assets](const double *args)
+			{
+				Audio::Sound<CDDA::Track> *track = CommandTrack(assets, args[0]);
+				if (track != nullptr)
+					track->Source()->SetLoop(args[1] != 0.0);
+			});
+
+			// Exit(), returns to the menu after this frame
+			commands.AddOp("Exit", [this](const double *args)
+			{
+				(void)args;
+				exit_requested = true;
+			});
+		}
+	}
+}
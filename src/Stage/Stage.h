@@ -0,0 +1,57 @@
+/*
+ * [PaperPup]
+ *   Stage.h
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#pragma once
+
+#include "PaperPup.h"
+
+#include "Engine.h"
+#include "Pack.h"
+#include "LuaController.h"
+
+#include <memory>
+
+namespace PaperPup
+{
+	namespace Stage
+	{
+		// Stage state class
+		// Plays a song, running its module's Start on a frame driven Lua controller of its own
+		class Stage : public State
+		{
+			private:
+				// Song being played, the pack is handed over by the menu
+				std::unique_ptr<Pack> pack;
+				size_t song_index;
+
+				// Gameplay controller, stepped and collected by the engine each frame
+				std::unique_ptr<Lua::LuaController> lua;
+
+				// Set by the Exit command
+				bool exit_requested = false;
+
+			public:
+				// Stage state interface
+				Stage(std::unique_ptr<Pack> _pack, size_t _song_index);
+				~Stage() override;
+
+				State *Start() override;
+
+				// Scripts and their requires are read from the pack's image
+				Filesystem::Archive *OpenArchive(std::string name) override { return pack->Image()->OpenArchive(name); }
+				Filesystem::File *OpenFile(std::string name, bool mode2) override { return pack->Image()->OpenFile(name, mode2); }
+				Filesystem::File *OpenBytecode(std::string name) override { return pack->Image()->OpenBytecode(name); }
+
+			private:
+				void RegisterOps(AssetLoader *assets);
+		};
+	}
+}
@@ -0,0 +1,157 @@
+/*
+ * [PaperPup]
+ *   LuauBench.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <lua.h>
+#include <lualib.h>
+
+#include <Luau/Compiler.h>
+#include <Luau/CodeGen.h>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+namespace PaperPup
+{
+	namespace LuauBench
+	{
+		// Benchmark workloads, each returning a function run once per simulated frame
+		struct Workload
+		{
+			const char *name;
+			const char *source;
+		};
+
+		static const Workload WORKLOADS[] = {
+			{
+				"judgement",
+				R"(--!native
+				local notes = {}
+				for i = 1, 2048 do
+					notes[i] = { time = i * 0.25, button = i % 6, hit = false }
+				end
+				local windows = { 0.033, 0.066, 0.1 }
+				return function(frame)
+					local now = (frame % 2048) * 0.25
+					local score = 0
+					for i = 1, #notes do
+						local note = notes[i]
+						local delta = math.abs(note.time - now)
+						for j = 1, #windows do
+							if delta <= windows[j] then
+								score += 4 - j
+								break
+							end
+						end
+					end
+					return score
+				end)"
+			},
+			{
+				"sprites",
+				R"(--!native
+				local sprites = {}
+				for i = 1, 1024 do
+					sprites[i] = { x = i, y = i * 2, vx = 1.5, vy = -0.5, angle = 0 }
+				end
+				return function(frame)
+					for i = 1, #sprites do
+						local sprite = sprites[i]
+						sprite.x += sprite.vx
+						sprite.y += sprite.vy
+						sprite.angle = (sprite.angle + 0.05) % (2 * math.pi)
+						if sprite.x > 640 or sprite.x < 0 then sprite.vx = -sprite.vx end
+						if sprite.y > 480 or sprite.y < 0 then sprite.vy = -sprite.vy end
+					end
+					return #sprites
+				end)"
+			},
+			{
+				"chart",
+				R"(--!native
+				local function lerp(a, b, t) return a + (b - a) * t end
+				return function(frame)
+					local sum = 0
+					for i = 1, 20000 do
+						local t = (i + frame) / 20000
+						sum += lerp(0, 480, t * t * (3 - 2 * t))
+					end
+					return sum
+				end)"
+			},
+		};
+
+		static constexpr int FRAMES = 600;
+
+		// Benchmark runner
+		static double Run(const Workload &workload, bool native)
+		{
+			// Create state
+			lua_State *state = luaL_newstate();
+			luaL_openlibs(state);
+			if (native)
+				Luau::CodeGen::create(state);
+
+			// Compile and load workload
+			Luau::CompileOptions options{};
+			options.optimizationLevel = 2;
+			std::string bytecode = Luau::compile(workload.source, options);
+			if (luau_load(state, workload.name, bytecode.data(), bytecode.size(), 0) != 0)
+			{
+				std::cerr << "Failed to load " << workload.name << ": " << lua_tostring(state, -1) << std::endl;
+				lua_close(state);
+				return 0.0;
+			}
+			if (native)
+				Luau::CodeGen::compile(state, -1);
+			lua_call(state, 0, 1);
+
+			// Run frames
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < FRAMES; i++)
+			{
+				lua_pushvalue(state, -1);
+				lua_pushnumber(state, i);
+				lua_call(state, 1, 0);
+			}
+			auto end = std::chrono::steady_clock::now();
+
+			lua_close(state);
+			return std::chrono::duration<double, std::micro>(end - start).count() / FRAMES;
+		}
+	}
+}
+
+int main()
+{
+	using namespace PaperPup::LuauBench;
+
+	if (!Luau::CodeGen::isSupported())
+	{
+		std::cerr << "Native code generation isn't supported on this platform" << std::endl;
+		return 1;
+	}
+
+	// Print per frame times
+	std::cout << std::left << std::setw(12) << "workload" << std::setw(16) << "interp (us)" << std::setw(16) << "native (us)" << "speedup" << std::endl;
+	for (auto &workload : WORKLOADS)
+	{
+		double interp = Run(workload, false);
+		double native = Run(workload, true);
+		std::cout << std::fixed << std::setprecision(2)
+			<< std::setw(12) << workload.name
+			<< std::setw(16) << interp
+			<< std::setw(16) << native
+			<< (native > 0.0 ? interp / native : 0.0) << "x" << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,200 @@
+/*
+ * [PaperPup]
+ *   Transcoder.cpp
+ * Author(s): PaperPup Contributors
+ * Date: 10/18/2026
+
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include "Platform/Filesystem.h"
+#include "Platform/Common/Binary.h"
+#include "Platform/Common/IntArchive.h"
+#include "Platform/Common/Bundle.h"
+#include "Platform/Common/TIM.h"
+
+#include <Luau/Compiler.h>
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+
+namespace PaperPup
+{
+	namespace Transcoder
+	{
+		// Stdio binary
+		class Binary_Stdio : public Filesystem::Binary
+		{
+			private:
+				// Binary handle
+				std::FILE *handle_bin;
+
+			public:
+				// Binary interface
+				Binary_Stdio(std::FILE *_handle_bin) : handle_bin(_handle_bin)
+				{
+					// Parse binary directory
+					ParseDirectory();
+				}
+
+				~Binary_Stdio()
+				{
+					// Close binary file
+					std::fclose(handle_bin);
+				}
+
+				// Binary implementation
+				void SeekLBA(uint32_t lba) override
+				{
+					// Seek to LBA in file
+					if (std::fseek(handle_bin, (long)lba * Filesystem::SECTOR_MODE2, SEEK_SET) != 0)
+						throw PaperPup::RuntimeError("Binary seek failed");
+				}
+
+				void ReadSector(char *data, uint32_t count) override
+				{
+					// Read sector from file
+					if (std::fread(data, Filesystem::SECTOR_MODE2, count, handle_bin) != count)
+						throw PaperPup::RuntimeError("Binary read failed");
+				}
+		};
+
+		// Transcoder helpers
+		static bool EndsWith(const std::string &string, const char *suffix)
+		{
+			size_t suffix_length = std::strlen(suffix);
+			return string.size() >= suffix_length && string.compare(string.size() - suffix_length, suffix_length, suffix) == 0;
+		}
+
+		static bool IsForm2(Filesystem::Binary &binary, const std::string &name)
+		{
+			// Check the subheader of the first sector for the form 2 submode bit, marking XA/STR streams
+			std::unique_ptr<Filesystem::File> file(binary.OpenFile(name, true));
+			if (file == nullptr || file->Size() < Filesystem::SECTOR_MODE2)
+				return false;
+			return (file->Data()[0x012] & (1 << 5)) != 0;
+		}
+
+		// Transcoder entry point
+		static int Main(std::string path_bin, std::string path_bundle, int optimization_level, int debug_level)
+		{
+			// Compile with the options the engine will load bytecode with, see lua/optimization_level and lua/debug_level
+			Luau::CompileOptions compile_options;
+			compile_options.optimizationLevel = optimization_level;
+			compile_options.debugLevel = debug_level;
+
+			// Open binary
+			std::FILE *handle_bin = std::fopen(path_bin.c_str(), "rb");
+			if (handle_bin == nullptr)
+				throw PaperPup::RuntimeError("Failed to open " + path_bin);
+			Binary_Stdio binary(handle_bin);
+
+			// Open bundle
+			std::FILE *handle_bundle = std::fopen(path_bundle.c_str(), "wb");
+			if (handle_bundle == nullptr)
+				throw PaperPup::RuntimeError("Failed to create " + path_bundle);
+			std::unique_ptr<std::FILE, decltype(&std::fclose)> bundle_closer(handle_bundle, &std::fclose);
+
+			Filesystem::BundleWriter bundle(handle_bundle);
+
+			// Transcode files in a stable order
+			std::vector<std::string> names;
+			for (auto &i : binary.Directory())
+				names.push_back(i.first);
+			std::sort(names.begin(), names.end());
+
+			for (auto &name : names)
+			{
+				// Streams are only ever read as raw sectors
+				if (IsForm2(binary, name))
+				{
+					std::unique_ptr<Filesystem::File> file(binary.OpenFile(name, true));
+					bundle.Add(name, Filesystem::BUNDLE_TYPE_MODE2, file->Data(), file->Size());
+					std::cout << "MODE2    " << name << std::endl;
+					continue;
+				}
+
+				std::unique_ptr<Filesystem::File> file(binary.OpenFile(name, false));
+				bundle.Add(name, Filesystem::BUNDLE_TYPE_DATA, file->Data(), file->Size());
+
+				if (EndsWith(name, ".LUA"))
+				{
+					// Precompile module bytecode
+					std::string bytecode = Luau::compile(std::string(file->Data(), file->Size()), compile_options);
+					if (bytecode.empty() || bytecode[0] == 0)
+						throw PaperPup::RuntimeError("Failed to compile " + name + ": " + bytecode.substr(bytecode.empty() ? 0 : 1));
+
+					// Prefix with the options, so the engine can tell if the bytecode matches its settings
+					bytecode.insert(0, std::string({ (char)optimization_level, (char)debug_level, 0, 0 }));
+					bundle.Add(name, Filesystem::BUNDLE_TYPE_BYTECODE, bytecode.data(), bytecode.size());
+					std::cout << "BYTECODE " << name << std::endl;
+				}
+				else if (EndsWith(name, ".TIM"))
+				{
+					// Pre-decode texture, using the first CLUT like the engine does
+					try
+					{
+						std::vector<char> texture = TIM::Serialize(TIM::Decode((char*)file->Data(), file->Size()));
+						bundle.Add(name, Filesystem::BUNDLE_TYPE_TEXTURE, texture.data(), texture.size());
+						std::cout << "TEXTURE  " << name << std::endl;
+					}
+					catch (PaperPup::RuntimeError &exception)
+					{
+						// Leave textures we can't decode to the engine's loose data path
+						std::cout << "DATA     " << name << " (" << exception.what() << ")" << std::endl;
+					}
+				}
+				else if (EndsWith(name, ".INT"))
+				{
+					// Validate archive so the engine can slice it in place
+					Filesystem::IntArchive archive(new Filesystem::File(file->Data(), file->Size(), std::shared_ptr<const void>(file->Data(), [](const void*) {})));
+					std::cout << "ARCHIVE  " << name << std::endl;
+				}
+				else
+				{
+					std::cout << "DATA     " << name << std::endl;
+				}
+			}
+
+			bundle.Finish();
+			return 0;
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	// Check arguments
+	int optimization_level = 1, debug_level = 1;
+	int arg = 1;
+	for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2)
+	{
+		if (std::strcmp(argv[arg], "-O") == 0)
+			optimization_level = std::clamp(std::atoi(argv[arg + 1]), 0, 2);
+		else if (std::strcmp(argv[arg], "-g") == 0)
+			debug_level = std::clamp(std::atoi(argv[arg + 1]), 0, 2);
+		else
+			break;
+	}
+	if ((argc - arg) != 2)
+	{
+		std::cerr << "Usage: " << argv[0] << " [-O <optimization level>] [-g <debug level>] <image.bin> <image.bundle>" << std::endl;
+		return 1;
+	}
+
+	// Run transcoder
+	try
+	{
+		return PaperPup::Transcoder::Main(argv[arg], argv[arg + 1], optimization_level, debug_level);
+	}
+	catch (PaperPup::RuntimeError &exception)
+	{
+		std::cerr << "Transcoder Error: " << exception.what() << std::endl;
+		return 1;
+	}
+}